@@ -0,0 +1,300 @@
+// Generated by tools/gen_geometry.py, do not edit by hand.
+//
+// GEOMETRY_COS[i] is radius * cos(i / 2 degrees) in Q16 fixed point, so
+// every point on the dial is a difference of two table entries. Only the
+// table for the screen being built for is compiled in.
+
+#pragma once
+
+#include <stdint.h>
+
+#define GEOMETRY_STEPS 720
+#define GEOMETRY_SHIFT 16
+#define GEOMETRY_SCALE (1 << GEOMETRY_SHIFT)
+
+#if defined(PBL_PLATFORM_CHALK) // 180x180
+#define GEOMETRY_RADIUS 312
+#define GEOMETRY_HAND_LENGTH 142
+static const int32_t GEOMETRY_COS[GEOMETRY_STEPS] = {
+	20447232, 20446453, 20444118, 20440225, 20434776, 20427771, 20419210, 20409094,
+	20397424, 20384200, 20369424, 20353097, 20335220, 20315794, 20294821, 20272303,
+	20248241, 20222637, 20195493, 20166811, 20136593, 20104841, 20071559, 20036748,
+	20000411, 19962551, 19923171, 19882273, 19839862, 19795939, 19750509, 19703575,
+	19655141, 19605210, 19553785, 19500872, 19446473, 19390594, 19333238, 19274409,
+	19214113, 19152354, 19089136, 19024464, 18958343, 18890779, 18821776, 18751340,
+	18679476, 18606189, 18531486, 18455371, 18377850, 18298931, 18218617, 18136916,
+	18053834, 17969377, 17883552, 17796365, 17707822, 17617931, 17526699, 17434131,
+	17340236, 17245021, 17148492, 17050657, 16951524, 16851099, 16749392, 16646409,
+	16542158, 16436648, 16329886, 16221880, 16112639, 16002171, 15890484, 15777587,
+	15663488, 15548197, 15431722, 15314071, 15195255, 15075281, 14954159, 14831898,
+	14708508, 14583997, 14458376, 14331654, 14203841, 14074946, 13944979, 13813950,
+	13681869, 13548746, 13414591, 13279415, 13143227, 13006039, 12867860, 12728701,
+	12588573, 12447486, 12305451, 12162480, 12018581, 11873768, 11728050, 11581440,
+	11433947, 11285584, 11136361, 10986290, 10835382, 10683649, 10531103, 10377755,
+	10223616, 10068699, 9913015, 9756576, 9599394, 9441481, 9282849, 9123510,
+	8963477, 8802760, 8641374, 8479329, 8316639, 8153315, 7989370, 7824817,
+	7659668, 7493936, 7327633, 7160772, 6993365, 6825426, 6656968, 6488002,
+	6318542, 6148601, 5978192, 5807328, 5636021, 5464285, 5292133, 5119578,
+	4946633, 4773312, 4599626, 4425591, 4251219, 4076522, 3901516, 3726212,
+	3550625, 3374767, 3198652, 3022293, 2845705, 2668899, 2491891, 2314692,
+	2137318, 1959780, 1782094, 1604271, 1426327, 1248274, 1070125, 891896,
+	713598, 535246, 356853, 178433, 0, -178433, -356853, -535246,
+	-713598, -891896, -1070125, -1248274, -1426327, -1604271, -1782094, -1959780,
+	-2137318, -2314692, -2491891, -2668899, -2845705, -3022293, -3198652, -3374767,
+	-3550625, -3726212, -3901516, -4076522, -4251219, -4425591, -4599626, -4773312,
+	-4946633, -5119578, -5292133, -5464285, -5636021, -5807328, -5978192, -6148601,
+	-6318542, -6488002, -6656968, -6825426, -6993365, -7160772, -7327633, -7493936,
+	-7659668, -7824817, -7989370, -8153315, -8316639, -8479329, -8641374, -8802760,
+	-8963477, -9123510, -9282849, -9441481, -9599394, -9756576, -9913015, -10068699,
+	-10223616, -10377755, -10531103, -10683649, -10835382, -10986290, -11136361, -11285584,
+	-11433947, -11581440, -11728050, -11873768, -12018581, -12162480, -12305451, -12447486,
+	-12588573, -12728701, -12867860, -13006039, -13143227, -13279415, -13414591, -13548746,
+	-13681869, -13813950, -13944979, -14074946, -14203841, -14331654, -14458376, -14583997,
+	-14708508, -14831898, -14954159, -15075281, -15195255, -15314071, -15431722, -15548197,
+	-15663488, -15777587, -15890484, -16002171, -16112639, -16221880, -16329886, -16436648,
+	-16542158, -16646409, -16749392, -16851099, -16951524, -17050657, -17148492, -17245021,
+	-17340236, -17434131, -17526699, -17617931, -17707822, -17796365, -17883552, -17969377,
+	-18053834, -18136916, -18218617, -18298931, -18377850, -18455371, -18531486, -18606189,
+	-18679476, -18751340, -18821776, -18890779, -18958343, -19024464, -19089136, -19152354,
+	-19214113, -19274409, -19333238, -19390594, -19446473, -19500872, -19553785, -19605210,
+	-19655141, -19703575, -19750509, -19795939, -19839862, -19882273, -19923171, -19962551,
+	-20000411, -20036748, -20071559, -20104841, -20136593, -20166811, -20195493, -20222637,
+	-20248241, -20272303, -20294821, -20315794, -20335220, -20353097, -20369424, -20384200,
+	-20397424, -20409094, -20419210, -20427771, -20434776, -20440225, -20444118, -20446453,
+	-20447232, -20446453, -20444118, -20440225, -20434776, -20427771, -20419210, -20409094,
+	-20397424, -20384200, -20369424, -20353097, -20335220, -20315794, -20294821, -20272303,
+	-20248241, -20222637, -20195493, -20166811, -20136593, -20104841, -20071559, -20036748,
+	-20000411, -19962551, -19923171, -19882273, -19839862, -19795939, -19750509, -19703575,
+	-19655141, -19605210, -19553785, -19500872, -19446473, -19390594, -19333238, -19274409,
+	-19214113, -19152354, -19089136, -19024464, -18958343, -18890779, -18821776, -18751340,
+	-18679476, -18606189, -18531486, -18455371, -18377850, -18298931, -18218617, -18136916,
+	-18053834, -17969377, -17883552, -17796365, -17707822, -17617931, -17526699, -17434131,
+	-17340236, -17245021, -17148492, -17050657, -16951524, -16851099, -16749392, -16646409,
+	-16542158, -16436648, -16329886, -16221880, -16112639, -16002171, -15890484, -15777587,
+	-15663488, -15548197, -15431722, -15314071, -15195255, -15075281, -14954159, -14831898,
+	-14708508, -14583997, -14458376, -14331654, -14203841, -14074946, -13944979, -13813950,
+	-13681869, -13548746, -13414591, -13279415, -13143227, -13006039, -12867860, -12728701,
+	-12588573, -12447486, -12305451, -12162480, -12018581, -11873768, -11728050, -11581440,
+	-11433947, -11285584, -11136361, -10986290, -10835382, -10683649, -10531103, -10377755,
+	-10223616, -10068699, -9913015, -9756576, -9599394, -9441481, -9282849, -9123510,
+	-8963477, -8802760, -8641374, -8479329, -8316639, -8153315, -7989370, -7824817,
+	-7659668, -7493936, -7327633, -7160772, -6993365, -6825426, -6656968, -6488002,
+	-6318542, -6148601, -5978192, -5807328, -5636021, -5464285, -5292133, -5119578,
+	-4946633, -4773312, -4599626, -4425591, -4251219, -4076522, -3901516, -3726212,
+	-3550625, -3374767, -3198652, -3022293, -2845705, -2668899, -2491891, -2314692,
+	-2137318, -1959780, -1782094, -1604271, -1426327, -1248274, -1070125, -891896,
+	-713598, -535246, -356853, -178433, 0, 178433, 356853, 535246,
+	713598, 891896, 1070125, 1248274, 1426327, 1604271, 1782094, 1959780,
+	2137318, 2314692, 2491891, 2668899, 2845705, 3022293, 3198652, 3374767,
+	3550625, 3726212, 3901516, 4076522, 4251219, 4425591, 4599626, 4773312,
+	4946633, 5119578, 5292133, 5464285, 5636021, 5807328, 5978192, 6148601,
+	6318542, 6488002, 6656968, 6825426, 6993365, 7160772, 7327633, 7493936,
+	7659668, 7824817, 7989370, 8153315, 8316639, 8479329, 8641374, 8802760,
+	8963477, 9123510, 9282849, 9441481, 9599394, 9756576, 9913015, 10068699,
+	10223616, 10377755, 10531103, 10683649, 10835382, 10986290, 11136361, 11285584,
+	11433947, 11581440, 11728050, 11873768, 12018581, 12162480, 12305451, 12447486,
+	12588573, 12728701, 12867860, 13006039, 13143227, 13279415, 13414591, 13548746,
+	13681869, 13813950, 13944979, 14074946, 14203841, 14331654, 14458376, 14583997,
+	14708508, 14831898, 14954159, 15075281, 15195255, 15314071, 15431722, 15548197,
+	15663488, 15777587, 15890484, 16002171, 16112639, 16221880, 16329886, 16436648,
+	16542158, 16646409, 16749392, 16851099, 16951524, 17050657, 17148492, 17245021,
+	17340236, 17434131, 17526699, 17617931, 17707822, 17796365, 17883552, 17969377,
+	18053834, 18136916, 18218617, 18298931, 18377850, 18455371, 18531486, 18606189,
+	18679476, 18751340, 18821776, 18890779, 18958343, 19024464, 19089136, 19152354,
+	19214113, 19274409, 19333238, 19390594, 19446473, 19500872, 19553785, 19605210,
+	19655141, 19703575, 19750509, 19795939, 19839862, 19882273, 19923171, 19962551,
+	20000411, 20036748, 20071559, 20104841, 20136593, 20166811, 20195493, 20222637,
+	20248241, 20272303, 20294821, 20315794, 20335220, 20353097, 20369424, 20384200,
+	20397424, 20409094, 20419210, 20427771, 20434776, 20440225, 20444118, 20446453,
+};
+#elif defined(PBL_PLATFORM_EMERY) // 200x228
+#define GEOMETRY_RADIUS 348
+#define GEOMETRY_HAND_LENGTH 166
+static const int32_t GEOMETRY_COS[GEOMETRY_STEPS] = {
+	22806528, 22805660, 22803054, 22798713, 22792635, 22784821, 22775272, 22763989,
+	22750972, 22736223, 22719742, 22701531, 22681591, 22659924, 22636532, 22611415,
+	22584576, 22556018, 22525742, 22493750, 22460046, 22424631, 22387508, 22348680,
+	22308151, 22265922, 22221998, 22176382, 22129077, 22080086, 22029414, 21977065,
+	21923042, 21867349, 21809991, 21750972, 21690297, 21627970, 21563996, 21498380,
+	21431126, 21362241, 21291728, 21219594, 21145845, 21070484, 20993520, 20914956,
+	20834800, 20753057, 20669734, 20584837, 20498372, 20410346, 20320765, 20229637,
+	20136969, 20042767, 19947039, 19849792, 19751033, 19650770, 19549010, 19445762,
+	19341033, 19234831, 19127164, 19018040, 18907469, 18795457, 18682014, 18567148,
+	18450869, 18333184, 18214103, 18093635, 17971789, 17848575, 17724001, 17598078,
+	17470814, 17342220, 17212305, 17081080, 16948553, 16814736, 16679639, 16543271,
+	16405643, 16266766, 16126651, 15985307, 15842746, 15698978, 15554015, 15407867,
+	15260546, 15112063, 14962429, 14811655, 14659754, 14506736, 14352613, 14197397,
+	14041101, 13883735, 13725311, 13565843, 13405341, 13243818, 13081287, 12917760,
+	12753249, 12587766, 12421325, 12253939, 12085619, 11916378, 11746230, 11575188,
+	11403264, 11230472, 11056824, 10882335, 10707016, 10530883, 10353947, 10176223,
+	9997724, 9818463, 9638455, 9457713, 9276251, 9094082, 8911220, 8727680,
+	8543476, 8358620, 8173129, 7987014, 7800292, 7612975, 7425079, 7236618,
+	7047605, 6858055, 6667983, 6477404, 6286331, 6094780, 5902764, 5710299,
+	5517398, 5324078, 5130353, 4936236, 4741744, 4546890, 4351691, 4156160,
+	3960312, 3764163, 3567727, 3371019, 3174055, 2976849, 2779417, 2581772,
+	2383931, 2185909, 1987720, 1789380, 1590903, 1392305, 1193601, 994807,
+	795936, 597005, 398029, 199022, 0, -199022, -398029, -597005,
+	-795936, -994807, -1193601, -1392305, -1590903, -1789380, -1987720, -2185909,
+	-2383931, -2581772, -2779417, -2976849, -3174055, -3371019, -3567727, -3764163,
+	-3960312, -4156160, -4351691, -4546890, -4741744, -4936236, -5130353, -5324078,
+	-5517398, -5710299, -5902764, -6094780, -6286331, -6477404, -6667983, -6858055,
+	-7047605, -7236618, -7425079, -7612975, -7800292, -7987014, -8173129, -8358620,
+	-8543476, -8727680, -8911220, -9094082, -9276251, -9457713, -9638455, -9818463,
+	-9997724, -10176223, -10353947, -10530883, -10707016, -10882335, -11056824, -11230472,
+	-11403264, -11575188, -11746230, -11916378, -12085619, -12253939, -12421325, -12587766,
+	-12753249, -12917760, -13081287, -13243818, -13405341, -13565843, -13725311, -13883735,
+	-14041101, -14197397, -14352613, -14506736, -14659754, -14811655, -14962429, -15112063,
+	-15260546, -15407867, -15554015, -15698978, -15842746, -15985307, -16126651, -16266766,
+	-16405643, -16543271, -16679639, -16814736, -16948553, -17081080, -17212305, -17342220,
+	-17470814, -17598078, -17724001, -17848575, -17971789, -18093635, -18214103, -18333184,
+	-18450869, -18567148, -18682014, -18795457, -18907469, -19018040, -19127164, -19234831,
+	-19341033, -19445762, -19549010, -19650770, -19751033, -19849792, -19947039, -20042767,
+	-20136969, -20229637, -20320765, -20410346, -20498372, -20584837, -20669734, -20753057,
+	-20834800, -20914956, -20993520, -21070484, -21145845, -21219594, -21291728, -21362241,
+	-21431126, -21498380, -21563996, -21627970, -21690297, -21750972, -21809991, -21867349,
+	-21923042, -21977065, -22029414, -22080086, -22129077, -22176382, -22221998, -22265922,
+	-22308151, -22348680, -22387508, -22424631, -22460046, -22493750, -22525742, -22556018,
+	-22584576, -22611415, -22636532, -22659924, -22681591, -22701531, -22719742, -22736223,
+	-22750972, -22763989, -22775272, -22784821, -22792635, -22798713, -22803054, -22805660,
+	-22806528, -22805660, -22803054, -22798713, -22792635, -22784821, -22775272, -22763989,
+	-22750972, -22736223, -22719742, -22701531, -22681591, -22659924, -22636532, -22611415,
+	-22584576, -22556018, -22525742, -22493750, -22460046, -22424631, -22387508, -22348680,
+	-22308151, -22265922, -22221998, -22176382, -22129077, -22080086, -22029414, -21977065,
+	-21923042, -21867349, -21809991, -21750972, -21690297, -21627970, -21563996, -21498380,
+	-21431126, -21362241, -21291728, -21219594, -21145845, -21070484, -20993520, -20914956,
+	-20834800, -20753057, -20669734, -20584837, -20498372, -20410346, -20320765, -20229637,
+	-20136969, -20042767, -19947039, -19849792, -19751033, -19650770, -19549010, -19445762,
+	-19341033, -19234831, -19127164, -19018040, -18907469, -18795457, -18682014, -18567148,
+	-18450869, -18333184, -18214103, -18093635, -17971789, -17848575, -17724001, -17598078,
+	-17470814, -17342220, -17212305, -17081080, -16948553, -16814736, -16679639, -16543271,
+	-16405643, -16266766, -16126651, -15985307, -15842746, -15698978, -15554015, -15407867,
+	-15260546, -15112063, -14962429, -14811655, -14659754, -14506736, -14352613, -14197397,
+	-14041101, -13883735, -13725311, -13565843, -13405341, -13243818, -13081287, -12917760,
+	-12753249, -12587766, -12421325, -12253939, -12085619, -11916378, -11746230, -11575188,
+	-11403264, -11230472, -11056824, -10882335, -10707016, -10530883, -10353947, -10176223,
+	-9997724, -9818463, -9638455, -9457713, -9276251, -9094082, -8911220, -8727680,
+	-8543476, -8358620, -8173129, -7987014, -7800292, -7612975, -7425079, -7236618,
+	-7047605, -6858055, -6667983, -6477404, -6286331, -6094780, -5902764, -5710299,
+	-5517398, -5324078, -5130353, -4936236, -4741744, -4546890, -4351691, -4156160,
+	-3960312, -3764163, -3567727, -3371019, -3174055, -2976849, -2779417, -2581772,
+	-2383931, -2185909, -1987720, -1789380, -1590903, -1392305, -1193601, -994807,
+	-795936, -597005, -398029, -199022, 0, 199022, 398029, 597005,
+	795936, 994807, 1193601, 1392305, 1590903, 1789380, 1987720, 2185909,
+	2383931, 2581772, 2779417, 2976849, 3174055, 3371019, 3567727, 3764163,
+	3960312, 4156160, 4351691, 4546890, 4741744, 4936236, 5130353, 5324078,
+	5517398, 5710299, 5902764, 6094780, 6286331, 6477404, 6667983, 6858055,
+	7047605, 7236618, 7425079, 7612975, 7800292, 7987014, 8173129, 8358620,
+	8543476, 8727680, 8911220, 9094082, 9276251, 9457713, 9638455, 9818463,
+	9997724, 10176223, 10353947, 10530883, 10707016, 10882335, 11056824, 11230472,
+	11403264, 11575188, 11746230, 11916378, 12085619, 12253939, 12421325, 12587766,
+	12753249, 12917760, 13081287, 13243818, 13405341, 13565843, 13725311, 13883735,
+	14041101, 14197397, 14352613, 14506736, 14659754, 14811655, 14962429, 15112063,
+	15260546, 15407867, 15554015, 15698978, 15842746, 15985307, 16126651, 16266766,
+	16405643, 16543271, 16679639, 16814736, 16948553, 17081080, 17212305, 17342220,
+	17470814, 17598078, 17724001, 17848575, 17971789, 18093635, 18214103, 18333184,
+	18450869, 18567148, 18682014, 18795457, 18907469, 19018040, 19127164, 19234831,
+	19341033, 19445762, 19549010, 19650770, 19751033, 19849792, 19947039, 20042767,
+	20136969, 20229637, 20320765, 20410346, 20498372, 20584837, 20669734, 20753057,
+	20834800, 20914956, 20993520, 21070484, 21145845, 21219594, 21291728, 21362241,
+	21431126, 21498380, 21563996, 21627970, 21690297, 21750972, 21809991, 21867349,
+	21923042, 21977065, 22029414, 22080086, 22129077, 22176382, 22221998, 22265922,
+	22308151, 22348680, 22387508, 22424631, 22460046, 22493750, 22525742, 22556018,
+	22584576, 22611415, 22636532, 22659924, 22681591, 22701531, 22719742, 22736223,
+	22750972, 22763989, 22775272, 22784821, 22792635, 22798713, 22803054, 22805660,
+};
+#else // aplite, basalt, 144x168
+#define GEOMETRY_RADIUS 250
+#define GEOMETRY_HAND_LENGTH 125
+static const int32_t GEOMETRY_COS[GEOMETRY_STEPS] = {
+	16384000, 16383376, 16381505, 16378386, 16374019, 16368406, 16361546, 16353441,
+	16344089, 16333494, 16321654, 16308571, 16294247, 16278681, 16261876, 16243833,
+	16224552, 16204036, 16182286, 16159303, 16135090, 16109648, 16082980, 16055086,
+	16025970, 15995634, 15964079, 15931309, 15897325, 15862131, 15825729, 15788121,
+	15749312, 15709303, 15668097, 15625699, 15582110, 15537335, 15491376, 15444238,
+	15395924, 15346437, 15295782, 15243961, 15190980, 15136842, 15081552, 15025112,
+	14967529, 14908805, 14848947, 14787957, 14725842, 14662605, 14598251, 14532785,
+	14466213, 14398540, 14329769, 14259908, 14188960, 14116932, 14043829, 13969656,
+	13894420, 13818125, 13740779, 13662385, 13582952, 13502483, 13420987, 13338469,
+	13254934, 13170391, 13084844, 12998301, 12910768, 12822252, 12732759, 12642297,
+	12550872, 12458491, 12365162, 12270891, 12175685, 12079552, 11982499, 11884534,
+	11785663, 11685895, 11585238, 11483697, 11381283, 11278001, 11173861, 11068870,
+	10963036, 10856367, 10748871, 10640557, 10531432, 10421506, 10310785, 10199280,
+	10086998, 9973947, 9860137, 9745577, 9630274, 9514237, 9397476, 9280000,
+	9161817, 9042936, 8923366, 8803117, 8682197, 8560616, 8438384, 8315509,
+	8192000, 8067868, 7943121, 7817769, 7691822, 7565289, 7438180, 7310505,
+	7182273, 7053494, 6924178, 6794334, 6663973, 6533105, 6401739, 6269885,
+	6137554, 6004756, 5871500, 5737798, 5603658, 5469092, 5334109, 5198719,
+	5062934, 4926764, 4790218, 4653307, 4516042, 4378434, 4240491, 4102226,
+	3963648, 3824769, 3685598, 3546147, 3406425, 3266444, 3126215, 2985747,
+	2845052, 2704140, 2563022, 2421709, 2280212, 2138541, 1996707, 1854721,
+	1712594, 1570337, 1427960, 1285474, 1142890, 1000219, 857472, 714660,
+	571793, 428883, 285940, 142976, 0, -142976, -285940, -428883,
+	-571793, -714660, -857472, -1000219, -1142890, -1285474, -1427960, -1570337,
+	-1712594, -1854721, -1996707, -2138541, -2280212, -2421709, -2563022, -2704140,
+	-2845052, -2985747, -3126215, -3266444, -3406425, -3546147, -3685598, -3824769,
+	-3963648, -4102226, -4240491, -4378434, -4516042, -4653307, -4790218, -4926764,
+	-5062934, -5198719, -5334109, -5469092, -5603658, -5737798, -5871500, -6004756,
+	-6137554, -6269885, -6401739, -6533105, -6663973, -6794334, -6924178, -7053494,
+	-7182273, -7310505, -7438180, -7565289, -7691822, -7817769, -7943121, -8067868,
+	-8192000, -8315509, -8438384, -8560616, -8682197, -8803117, -8923366, -9042936,
+	-9161817, -9280000, -9397476, -9514237, -9630274, -9745577, -9860137, -9973947,
+	-10086998, -10199280, -10310785, -10421506, -10531432, -10640557, -10748871, -10856367,
+	-10963036, -11068870, -11173861, -11278001, -11381283, -11483697, -11585238, -11685895,
+	-11785663, -11884534, -11982499, -12079552, -12175685, -12270891, -12365162, -12458491,
+	-12550872, -12642297, -12732759, -12822252, -12910768, -12998301, -13084844, -13170391,
+	-13254934, -13338469, -13420987, -13502483, -13582952, -13662385, -13740779, -13818125,
+	-13894420, -13969656, -14043829, -14116932, -14188960, -14259908, -14329769, -14398540,
+	-14466213, -14532785, -14598251, -14662605, -14725842, -14787957, -14848947, -14908805,
+	-14967529, -15025112, -15081552, -15136842, -15190980, -15243961, -15295782, -15346437,
+	-15395924, -15444238, -15491376, -15537335, -15582110, -15625699, -15668097, -15709303,
+	-15749312, -15788121, -15825729, -15862131, -15897325, -15931309, -15964079, -15995634,
+	-16025970, -16055086, -16082980, -16109648, -16135090, -16159303, -16182286, -16204036,
+	-16224552, -16243833, -16261876, -16278681, -16294247, -16308571, -16321654, -16333494,
+	-16344089, -16353441, -16361546, -16368406, -16374019, -16378386, -16381505, -16383376,
+	-16384000, -16383376, -16381505, -16378386, -16374019, -16368406, -16361546, -16353441,
+	-16344089, -16333494, -16321654, -16308571, -16294247, -16278681, -16261876, -16243833,
+	-16224552, -16204036, -16182286, -16159303, -16135090, -16109648, -16082980, -16055086,
+	-16025970, -15995634, -15964079, -15931309, -15897325, -15862131, -15825729, -15788121,
+	-15749312, -15709303, -15668097, -15625699, -15582110, -15537335, -15491376, -15444238,
+	-15395924, -15346437, -15295782, -15243961, -15190980, -15136842, -15081552, -15025112,
+	-14967529, -14908805, -14848947, -14787957, -14725842, -14662605, -14598251, -14532785,
+	-14466213, -14398540, -14329769, -14259908, -14188960, -14116932, -14043829, -13969656,
+	-13894420, -13818125, -13740779, -13662385, -13582952, -13502483, -13420987, -13338469,
+	-13254934, -13170391, -13084844, -12998301, -12910768, -12822252, -12732759, -12642297,
+	-12550872, -12458491, -12365162, -12270891, -12175685, -12079552, -11982499, -11884534,
+	-11785663, -11685895, -11585238, -11483697, -11381283, -11278001, -11173861, -11068870,
+	-10963036, -10856367, -10748871, -10640557, -10531432, -10421506, -10310785, -10199280,
+	-10086998, -9973947, -9860137, -9745577, -9630274, -9514237, -9397476, -9280000,
+	-9161817, -9042936, -8923366, -8803117, -8682197, -8560616, -8438384, -8315509,
+	-8192000, -8067868, -7943121, -7817769, -7691822, -7565289, -7438180, -7310505,
+	-7182273, -7053494, -6924178, -6794334, -6663973, -6533105, -6401739, -6269885,
+	-6137554, -6004756, -5871500, -5737798, -5603658, -5469092, -5334109, -5198719,
+	-5062934, -4926764, -4790218, -4653307, -4516042, -4378434, -4240491, -4102226,
+	-3963648, -3824769, -3685598, -3546147, -3406425, -3266444, -3126215, -2985747,
+	-2845052, -2704140, -2563022, -2421709, -2280212, -2138541, -1996707, -1854721,
+	-1712594, -1570337, -1427960, -1285474, -1142890, -1000219, -857472, -714660,
+	-571793, -428883, -285940, -142976, 0, 142976, 285940, 428883,
+	571793, 714660, 857472, 1000219, 1142890, 1285474, 1427960, 1570337,
+	1712594, 1854721, 1996707, 2138541, 2280212, 2421709, 2563022, 2704140,
+	2845052, 2985747, 3126215, 3266444, 3406425, 3546147, 3685598, 3824769,
+	3963648, 4102226, 4240491, 4378434, 4516042, 4653307, 4790218, 4926764,
+	5062934, 5198719, 5334109, 5469092, 5603658, 5737798, 5871500, 6004756,
+	6137554, 6269885, 6401739, 6533105, 6663973, 6794334, 6924178, 7053494,
+	7182273, 7310505, 7438180, 7565289, 7691822, 7817769, 7943121, 8067868,
+	8192000, 8315509, 8438384, 8560616, 8682197, 8803117, 8923366, 9042936,
+	9161817, 9280000, 9397476, 9514237, 9630274, 9745577, 9860137, 9973947,
+	10086998, 10199280, 10310785, 10421506, 10531432, 10640557, 10748871, 10856367,
+	10963036, 11068870, 11173861, 11278001, 11381283, 11483697, 11585238, 11685895,
+	11785663, 11884534, 11982499, 12079552, 12175685, 12270891, 12365162, 12458491,
+	12550872, 12642297, 12732759, 12822252, 12910768, 12998301, 13084844, 13170391,
+	13254934, 13338469, 13420987, 13502483, 13582952, 13662385, 13740779, 13818125,
+	13894420, 13969656, 14043829, 14116932, 14188960, 14259908, 14329769, 14398540,
+	14466213, 14532785, 14598251, 14662605, 14725842, 14787957, 14848947, 14908805,
+	14967529, 15025112, 15081552, 15136842, 15190980, 15243961, 15295782, 15346437,
+	15395924, 15444238, 15491376, 15537335, 15582110, 15625699, 15668097, 15709303,
+	15749312, 15788121, 15825729, 15862131, 15897325, 15931309, 15964079, 15995634,
+	16025970, 16055086, 16082980, 16109648, 16135090, 16159303, 16182286, 16204036,
+	16224552, 16243833, 16261876, 16278681, 16294247, 16308571, 16321654, 16333494,
+	16344089, 16353441, 16361546, 16368406, 16374019, 16378386, 16381505, 16383376,
+};
+#endif
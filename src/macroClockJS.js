@@ -1,11 +1,242 @@
-function appMessageAck(e) {
-	console.log("JSON options sent to Pebble");
+// MessageKeys in macroClockMain.c. The watch gets the settings as one byte
+// array of (key, value) pairs under 'config'.
+var MK_BACKGROUND_COLOR = 0;
+var MK_HOUR_COLOR = 1;
+var MK_HAND_COLOR = 2;
+var MK_DOT_COLOR = 3;
+var MK_HAND_OUTLINE_COLOR = 4;
+var MK_VIBE_TOGGLE = 5;
+var MK_HOUR_FORMAT = 6;
+var MK_VIBE_START = 7;
+var MK_VIBE_END = 8;
+var MK_DATE_TOGGLE = 9;
+var MK_DIG_TIME_TOGGLE = 10;
+var MK_BT_ALERT_TOGGLE = 11;
+var MK_HAND_OUTLINE_BOOL = 12;
+var MK_SMOOTH_MOTION = 13;
+var MK_CHIME_PATTERN = 16;
+var MK_NIGHT_MODE = 18;
+
+// GColor ARGB8 values of the named colors. Older pages only knew these, so
+// they are still what localStorage holds for most users.
+var COLOR_CODES = {
+	'blk': 0xC0, // GColorBlack
+	'wht': 0xFF, // GColorWhite
+	'red': 0xF0, // GColorRed
+	'org': 0xF8, // GColorOrange
+	'ylw': 0xFC, // GColorYellow
+	'grn': 0xC4, // GColorDarkGreen
+	'ble': 0xC2, // GColorDukeBlue
+	'prp': 0xD1, // GColorImperialPurple
+	'pnk': 0xF7, // GColorShockingPink
+	'gry': 0xD5  // GColorDarkGray
+};
+
+// Named color or "#RRGGBB" to a GColor ARGB8 byte. Every channel is
+// rounded to the nearest of the 4 levels the 64 color palette has.
+function colorValue(code) {
+	if (COLOR_CODES.hasOwnProperty(code)) {
+		return COLOR_CODES[code];
+	}
+	var rgb = /^#([0-9a-f]{2})([0-9a-f]{2})([0-9a-f]{2})$/i.exec(code);
+	if (!rgb) {
+		return undefined;
+	}
+	var argb = 0xC0;
+	for (var i = 1; i <= 3; i++) {
+		argb |= Math.round(parseInt(rgb[i], 16) / 85) << (2 * (3 - i));
+	}
+	return argb;
+}
+
+// "08a" is 8, "12a" is noon and "11p" is 23
+function hourValue(code) {
+	return parseInt(code.substr(0, 2), 10) + (code.charAt(2) === 'p' ? 12 : 0);
+}
+
+// The page keeps quiet hours as "SSEE" per day, Sunday first: quiet from
+// hour SS until hour EE, on into the next day when EE is before SS; the
+// same hour twice is off. The watch takes one bit per hour of the week,
+// QuietHours in quiet_hours.h.
+var QUIET_HOURS_SIZE = 7 * 24 / 8;
+
+function quietHoursBytes(windows) {
+	if (!/^[0-9]{28}$/.test(windows)) {
+		return undefined;
+	}
+	var bytes = [];
+	for (var i = 0; i < QUIET_HOURS_SIZE; i++) {
+		bytes.push(0);
+	}
+	for (var day = 0; day < 7; day++) {
+		var start = parseInt(windows.substr(day * 4, 2), 10);
+		var end = parseInt(windows.substr(day * 4 + 2, 2), 10);
+		if (start > 23 || end > 23) {
+			return undefined;
+		}
+		var weekHour = day * 24 + start;
+		for (var length = (end - start + 24) % 24; length > 0; length--) {
+			bytes[weekHour >> 3] |= 1 << (weekHour & 7);
+			weekHour = (weekHour + 1) % (7 * 24);
+		}
+	}
+	return bytes;
+}
+
+// Options the page did not send are left out, so the watch keeps its value
+function encodeOptions(options) {
+	var bytes = [];
+	
+	function pushColor(key, code) {
+		var argb = colorValue(code);
+		if (argb !== undefined) {
+			bytes.push(key, argb);
+		}
+	}
+	
+	function pushNumber(key, value) {
+		if (!isNaN(value)) {
+			bytes.push(key, value);
+		}
+	}
+	
+	function pushToggle(key, value, onValue) {
+		if (value !== undefined) {
+			bytes.push(key, value === onValue ? 1 : 0);
+		}
+	}
+	
+	pushColor(MK_BACKGROUND_COLOR, options['backgroundColor']);
+	pushColor(MK_HOUR_COLOR, options['hourColor']);
+	pushColor(MK_HAND_COLOR, options['handColor']);
+	pushColor(MK_DOT_COLOR, options['dotColor']);
+	if (options['handOutlineColor'] === 'nob') {
+		bytes.push(MK_HAND_OUTLINE_BOOL, 0);
+	}
+	else if (colorValue(options['handOutlineColor']) !== undefined) {
+		pushColor(MK_HAND_OUTLINE_COLOR, options['handOutlineColor']);
+		bytes.push(MK_HAND_OUTLINE_BOOL, 1);
+	}
+	pushToggle(MK_VIBE_TOGGLE, options['vibeToggle'], 'onn');
+	pushToggle(MK_HOUR_FORMAT, options['hourFormat'], '24h');
+	if (options['vibeStartTime'] !== undefined) {
+		pushNumber(MK_VIBE_START, hourValue(options['vibeStartTime']));
+	}
+	if (options['vibeEndTime'] !== undefined) {
+		pushNumber(MK_VIBE_END, hourValue(options['vibeEndTime']));
+	}
+	pushNumber(MK_DATE_TOGGLE, parseInt(options['dateToggle'], 10));
+	pushNumber(MK_DIG_TIME_TOGGLE, parseInt(options['digTimeToggle'], 10));
+	pushToggle(MK_BT_ALERT_TOGGLE, options['btAlertToggle'], 'onn');
+	pushToggle(MK_SMOOTH_MOTION, options['smoothMotion'], 'onn');
+	pushNumber(MK_CHIME_PATTERN, parseInt(options['chimePattern'], 10));
+	pushToggle(MK_NIGHT_MODE, options['nightMode'], 'onn');
+	
+	return bytes;
+}
+
+// Options that differ from what was last sent. Everything, if nothing was.
+function changedOptions(options, previous) {
+	if (previous === null) {
+		return options;
+	}
+	var changed = {};
+	for (var name in options) {
+		if (options.hasOwnProperty(name) && options[name] !== previous[name]) {
+			changed[name] = options[name];
+		}
+	}
+	return changed;
 }
 
-function appMessageNack(e) {
-	console.log("JSON options not sent to Pebble: " + e.error.message);
+// Transport for the config byte array. Pairs are split into chunks that fit
+// the watch inbox, app_message_open(128, 128), next to the seq tuple: one
+// dictionary header byte, then 7 header bytes per tuple plus the 4 byte seq.
+// Chunks go out one at a time; a NACK is retried with exponential backoff and
+// after MAX_RETRIES the rest of that configuration is dropped. Each chunk
+// carries a new sequence number so the watch can ignore a retried chunk it
+// already applied when only the ACK got lost.
+var INBOX_SIZE = 128;
+var MAX_CHUNK = (INBOX_SIZE - 1 - (7 + 4) - 7) & ~1;
+var MAX_RETRIES = 5;
+var RETRY_DELAY_MS = 250;
+
+// Everything the transport touches comes in from outside, so a test can run
+// it over a simulated channel: sendAppMessage(message, ack, nack) as on
+// Pebble, setTimeout, and the storage that keeps the sequence number across
+// launches. Returns sendConfig.
+function createTransport(sendAppMessage, setTimeout, storage) {
+	var sendQueue = [];
+	var sending = false;
+	var attempts = 0;
+	
+	function nextSeq() {
+		var seq = ((parseInt(storage.getItem('macroClockSeq'), 10) || 0) + 1) & 0x7fffffff;
+		storage.setItem('macroClockSeq', seq);
+		return seq;
+	}
+	
+	function sendNext() {
+		if (sending || sendQueue.length === 0) {
+			return;
+		}
+		sending = true;
+		var entry = sendQueue[0];
+		sendAppMessage(entry.message, function(e) {
+			console.log("Options chunk " + entry.message['seq'] + " sent to Pebble");
+			sendQueue.shift();
+			sending = false;
+			attempts = 0;
+			if (entry.done) {
+				entry.done();
+			}
+			sendNext();
+		}, function(e) {
+			attempts++;
+			if (attempts > MAX_RETRIES) {
+				console.log("Options not sent to Pebble, giving up: " + e.error.message);
+				sendQueue = sendQueue.filter(function(queued) {
+					return queued.transfer !== entry.transfer;
+				});
+				sending = false;
+				attempts = 0;
+				sendNext();
+				return;
+			}
+			var delay = RETRY_DELAY_MS << (attempts - 1);
+			console.log("Options chunk " + entry.message['seq'] + " not sent to Pebble, retrying in " + delay + " ms: " + e.error.message);
+			setTimeout(function() {
+				sending = false;
+				sendNext();
+			}, delay);
+		});
+	}
+	
+	// The quiet hours, when given, follow the pairs as a message of their own.
+	// done runs once the watch has acknowledged every chunk.
+	return function sendConfig(bytes, quietHours, done) {
+		var transfer = {};
+		for (var i = 0; i < bytes.length; i += MAX_CHUNK) {
+			sendQueue.push({
+				transfer: transfer,
+				message: { 'config': bytes.slice(i, i + MAX_CHUNK), 'seq': nextSeq() }
+			});
+		}
+		if (quietHours !== undefined) {
+			sendQueue.push({
+				transfer: transfer,
+				message: { 'quietHours': quietHours, 'seq': nextSeq() }
+			});
+		}
+		sendQueue[sendQueue.length - 1].done = done;
+		sendNext();
+	};
 }
 
+var sendConfig = createTransport(function(message, ack, nack) {
+	Pebble.sendAppMessage(message, ack, nack);
+}, setTimeout, window.localStorage);
+
 Pebble.addEventListener('showConfiguration', function(e) {
 	var options = JSON.parse(window.localStorage.getItem('macroClockOptions'));
 	var configLink = 'http://dustinhu.com/projects/library/MacroClock/Configuration.html';
@@ -21,7 +252,11 @@ Pebble.addEventListener('showConfiguration', function(e) {
 			'&vibeEndTime=' + encodeURIComponent(options['vibeEndTime']) + 
 			'&dateToggle=' + encodeURIComponent(options['dateToggle']) + 
 			'&digTimeToggle=' + encodeURIComponent(options['digTimeToggle']) +
-			'&btAlertToggle=' + encodeURIComponent(options['btAlertToggle'])
+			'&btAlertToggle=' + encodeURIComponent(options['btAlertToggle']) +
+			'&smoothMotion=' + encodeURIComponent(options['smoothMotion']) +
+			'&chimePattern=' + encodeURIComponent(options['chimePattern']) +
+			'&quietHours=' + encodeURIComponent(options['quietHours']) +
+			'&nightMode=' + encodeURIComponent(options['nightMode'])
 	}
 	console.log("opening " + configLink);
 	Pebble.openURL(configLink);
@@ -31,6 +266,26 @@ Pebble.addEventListener('webviewclosed', function(e) {
 	console.log('Configuration window returned: ' + e.response);
 	var options = JSON.parse(decodeURIComponent(e.response));
 	console.log("Options = " + JSON.stringify(options));
-	window.localStorage.setItem('macroClockOptions', JSON.stringify(options));
-	Pebble.sendAppMessage(options, appMessageAck, appMessageNack);
+	
+	var previous = JSON.parse(window.localStorage.getItem('macroClockOptions'));
+	var changed = changedOptions(options, previous);
+	var bytes = encodeOptions(changed);
+	var quietHours = quietHoursBytes(changed['quietHours']);
+	
+	// Pages that do not show every option must not drop the others
+	var stored = previous || {};
+	for (var name in options) {
+		if (options.hasOwnProperty(name)) {
+			stored[name] = options[name];
+		}
+	}
+	
+	if (bytes.length === 0 && quietHours === undefined) {
+		console.log("Options unchanged, nothing to send");
+		return;
+	}
+	// Only what the watch acknowledged becomes the base for the next diff
+	sendConfig(bytes, quietHours, function() {
+		window.localStorage.setItem('macroClockOptions', JSON.stringify(stored));
+	});
 });
\ No newline at end of file
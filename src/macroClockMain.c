@@ -1,9 +1,22 @@
 #include "pebble.h"
-#include <math.h>
 #include <stdio.h>
 #include <string.h>
+#include "geometry_table.h"
+#include "text_format.h"
+#include "quiet_hours.h"
 	
-#define M_PI 3.14
+// Angles are kept in TRIG_MAX_ANGLE units all the way to the geometry table
+#define DIAL_HOUR (TRIG_MAX_ANGLE / 12)
+#define DIAL_DOT_STEP (TRIG_MAX_ANGLE / 48)
+
+// Smooth hand motion: after each tick the hand glides to its new angle over
+// SMOOTH_DURATION_MS, redrawn at most SMOOTH_MAX_FPS times a second. At most
+// SMOOTH_FRAME_BUDGET frames are drawn per hour, enough for one glide a minute;
+// anything beyond that, and everything below the full render tier, snaps instead.
+#define SMOOTH_DURATION_MS 400
+#define SMOOTH_MAX_FPS 10
+#define SMOOTH_FRAMES (SMOOTH_DURATION_MS * SMOOTH_MAX_FPS / 1000)
+#define SMOOTH_FRAME_BUDGET (60 * SMOOTH_FRAMES)
 	
 // This defines graphics path information to be loaded as a path later
 static const GPathInfo LINE_PATH_POINTS = {
@@ -13,30 +26,34 @@ static const GPathInfo LINE_PATH_POINTS = {
   // The points should be defined in clockwise order due to the rendering
   // implementation. Counter-clockwise will work in older firmwares, but
   // it is not officially supported
+  // The hand reaches past the screen corners, so its length comes with the geometry table
   (GPoint []) {
-    {-3, 125},
-    {3, 125},
-    {3, -125},
-	{-3, -125}
+    {-3, GEOMETRY_HAND_LENGTH},
+    {3, GEOMETRY_HAND_LENGTH},
+    {3, -GEOMETRY_HAND_LENGTH},
+	{-3, -GEOMETRY_HAND_LENGTH}
   }
 };
 
+// The separator lines run along the inner edge of each date line. Their ends
+// depend on the screen size and are filled in by main_window_load.
+static GPoint s_top_line_points[2];
+static GPoint s_bot_line_points[2];
+
 static const GPathInfo TOP_LINE_POINTS = {
 	2,
-	(GPoint []) {
-		{0, 24},
-		{144, 24}
-	}
+	s_top_line_points
 };
 
 static const GPathInfo BOT_LINE_POINTS = {
 	2,
-	(GPoint []) {
-		{0, 143},
-		{144, 143}
-	}
+	s_bot_line_points
 };
 
+#define DATE_HEIGHT 24
+// On round screens the date lines move in from the edge to where they fit the circle
+#define DATE_INSET PBL_IF_ROUND_ELSE(12, 0)
+
 enum MessageKeys {
 	MK_BACKGROUND_COLOR = 0,
 	MK_HOUR_COLOR = 1,
@@ -50,7 +67,21 @@ enum MessageKeys {
 	MK_DATE_TOGGLE = 9,
 	MK_DIG_TIME_TOGGLE = 10,
 	MK_BT_ALERT_TOGGLE = 11,
-	MK_HAND_OUTLINE_BOOL = 12
+	MK_HAND_OUTLINE_BOOL = 12,
+	MK_SMOOTH_MOTION = 13,
+	// Byte array of (MessageKeys, value) pairs built by macroClockJS.js
+	MK_CONFIG = 14,
+	// Sequence number of an MK_CONFIG chunk. A chunk the phone retries because
+	// the ACK got lost repeats the number of the one already applied.
+	MK_SEQ = 15,
+	MK_CHIME_PATTERN = 16,
+	// QuietHours bits, sent as their own byte array next to MK_SEQ
+	MK_QUIET_HOURS = 17,
+	MK_NIGHT_MODE = 18
+};
+
+enum PersistKeys {
+	PK_SETTINGS = 100
 };
 
 enum DateToggle {
@@ -59,877 +90,1389 @@ enum DateToggle {
 	DT_ALWAYS_ON = 2
 };
 
-const int midWidth = 47;
-const int midHeight = 59;
-const int screenMidWidth = 72;
-const int screenMidHeight = 84;
-const int radius = 250;
-const int clockUnit = 30;
+// Hourly chime patterns. CP_DOUBLE is first so settings saved before there
+// was a choice, which read it as zero, keep the old double pulse.
+typedef enum {
+	CP_DOUBLE = 0,
+	CP_SINGLE,
+	CP_TRIPLE,
+	CP_LONG,
+	CP_COUNT
+} ChimePattern;
+
+static const uint32_t CHIME_DOUBLE[] = { 150, 150, 150 };
+static const uint32_t CHIME_SINGLE[] = { 150 };
+static const uint32_t CHIME_TRIPLE[] = { 150, 150, 150, 150, 150 };
+static const uint32_t CHIME_LONG[] = { 500 };
+
+static const VibePattern CHIME_PATTERNS[CP_COUNT] = {
+	[CP_DOUBLE] = { .durations = CHIME_DOUBLE, .num_segments = ARRAY_LENGTH(CHIME_DOUBLE) },
+	[CP_SINGLE] = { .durations = CHIME_SINGLE, .num_segments = ARRAY_LENGTH(CHIME_SINGLE) },
+	[CP_TRIPLE] = { .durations = CHIME_TRIPLE, .num_segments = ARRAY_LENGTH(CHIME_TRIPLE) },
+	[CP_LONG] = { .durations = CHIME_LONG, .num_segments = ARRAY_LENGTH(CHIME_LONG) }
+};
+
+// The current time sits at the screen center, where the dots are pinned; the
+// numerals are pinned by the top left of their 50x50 box. Set from the root
+// layer bounds in main_window_load.
+static int midWidth;
+static int midHeight;
+static int screenMidWidth;
+static int screenMidHeight;
 
 static Window *s_main_window;
 
-static TextLayer * s_time_layer;
-static TextLayer * s_time_layer2;
 static TextLayer * s_date_layer;
 static TextLayer * s_date_layer2;
 
-static Layer * s_path_layer;
-static GPath * s_line_path;
+// Numerals, dots, hand and separator lines are all drawn by this one layer
+static Layer * s_dial_layer;
+static GFont s_numeral_font;
 
-static Layer * topPathLayer;
-static GPath * topLinePath;
+// Dots and numerals only move with the hand, so they are rendered once per
+// (hour, angle) into this bitmap and blitted on every other redraw.
+static GBitmap * s_dial_cache;
+static bool s_dial_cache_valid;
+static int32_t s_cache_path_angle;
+static int32_t s_cache_hour_angle;
 
-static Layer * botPathLayer;
+static GPath * s_line_path;
+static GPath * topLinePath;
 static GPath * botLinePath;
 	
-static Layer * timeLayer;
-static Layer * timeLayer2;
+// Layer handles of the two date TextLayers, set right after they are created
 static Layer * dateLayer;
 static Layer * dateLayer2;
 
-static Layer * s_dot_layer;
+// Everything main_window_load creates is registered here in creation order,
+// and main_window_unload destroys it back to front through the one table.
+typedef enum {
+	RK_LAYER,
+	RK_TEXT_LAYER,
+	RK_GBITMAP,
+	RK_GPATH
+} ResourceKind;
 
-static int s_path_angle;
-static double s_path_angle_adj_rad;
-static int s_hour_angle;
-static double s_hour_angle_adj_rad;
+typedef struct {
+	ResourceKind kind;
+	void ** handle;
+} OwnedResource;
 
-static char buffer[2];
-static char buffer2[2];
-static char dateBuffer[16];
-static char dateBuffer2[9];
+#define MAX_OWNED_RESOURCES 8
+static OwnedResource s_owned[MAX_OWNED_RESOURCES];
+static int s_owned_count;
 
-static GColor backgroundColor;
-static GColor handColor;
-static GColor handBorderColor;
-static GColor dotColor;
-static GColor hourColor;
-static bool handBorderToggle;
+// Angle the hand and dial are drawn at. Equal to s_layout.pathAngle except
+// while s_hand_animation glides it there from s_anim_from_angle.
+static int32_t s_hand_angle;
+static Animation * s_hand_animation;
+static int32_t s_anim_from_angle;
+static int s_anim_frame;
+static int s_smooth_frames;
+static int s_smooth_budget_hour = -1;
 
-static bool vibeToggle;
-static int vibeStartTime;
-static int vibeEndTime;
+// Date lines set to show on a flick hide when this fires
+#define REVEAL_MS 3500
+static AppTimer * s_reveal_timer;
 
-static bool hourFormat;
+// Night mode: during quiet hours the face ticks hourly and draws only the
+// numerals. A tap brings back minute ticks until NIGHT_WAKE_S have passed.
+#define NIGHT_WAKE_S 60
+static bool s_night;
+static time_t s_night_wake_until;
+static TimeUnits s_tick_unit;
 
-static int dateToggle; //0 = Off, 1 = Flick, 2 = Always On
-static int digTimeToggle;
+// What the face draws, picked by battery_handler from the charge level.
+// Reduced drops the hand outline and the small dots, minimal everything but
+// the hand and numerals and ticks hourly. Charging is always full.
+#define TIER_REDUCED_BATTERY 30
+#define TIER_MINIMAL_BATTERY 10
 
-static bool btAlertToggle;
+typedef enum {
+	RT_FULL,
+	RT_REDUCED,
+	RT_MINIMAL
+} RenderTier;
 
-static double getCos(double angle) {		
-	return ( (double) cos_lookup(angle * TRIG_MAX_ANGLE / (2 * M_PI)) / (double) TRIG_MAX_RATIO);
-}
+static RenderTier s_tier;
 
-static double getSin(double angle) {
-	return ( (double) sin_lookup(angle * TRIG_MAX_ANGLE / (2 * M_PI)) / (double) TRIG_MAX_RATIO);
-}
+static bool s_has_seq;
+static int32_t s_last_seq;
 
+// Everything the face shows for one minute. Filled in by computeLayout from
+// the time and the settings alone, so main_window_load and update_time agree.
+typedef struct {
+	char hour[TEXT_NUMERAL_SIZE];
+	char nextHour[TEXT_NUMERAL_SIZE];
+	char date[TEXT_DATE_SIZE];
+	char digitalTime[TEXT_TIME_SIZE];
+	int32_t pathAngle;
+	int32_t hourAngle;
+	GRect hourFrame;
+	GRect nextHourFrame;
+} DialLayout;
 
-static int getHourInt(char* hourString) {
-	int toReturn = hourString[1] - '0';
-	if (hourString[0] == '1') {
-		toReturn += 10;
-	}
-	
-	if (hourString[2] == 'p') {
-		toReturn += 12;
-	}
-	
-	if (toReturn >= 0 && toReturn <= 23) {
-		return toReturn;
-	}
-	else {
-		APP_LOG(APP_LOG_LEVEL_DEBUG, "getHourInt(char*) returned an invalid integer value");
-		return 0;
+// What is on screen. The date TextLayers point straight at its strings.
+static DialLayout s_layout;
+
+// Decoded settings. Loaded from persistent storage once in init() and only
+// changed by in_received_handler; draw callbacks read nothing else.
+typedef struct {
+	GColor backgroundColor;
+	GColor handColor;
+	GColor handBorderColor;
+	GColor dotColor;
+	GColor hourColor;
+	bool handBorderToggle;
+	
+	bool vibeToggle;
+	int vibeStartTime;
+	int vibeEndTime;
+	int chimePattern;
+	// Silences the chime, and the bt alert once quietHoursSet. Rebuilt from
+	// the two times above whenever a companion that only knows them sets one.
+	QuietHours quietHours;
+	// Only a schedule the user chose, sent as MK_QUIET_HOURS, silences the bt
+	// alert; one rebuilt from the chime window never did before and still doesn't.
+	bool quietHoursSet;
+	
+	bool hourFormat;
+	
+	int dateToggle; //0 = Off, 1 = Flick, 2 = Always On
+	int digTimeToggle;
+	
+	bool btAlertToggle;
+	
+	bool smoothMotion;
+	
+	bool nightMode;
+} Settings;
+
+static Settings s_settings;
+
+// On-flash layout of Settings, kept under the single PK_SETTINGS key. Bump
+// SETTINGS_VERSION whenever this layout changes. Fields are only ever
+// appended, so a shorter blob from an older version still loads and the
+// fields it lacks read as zero.
+#define SETTINGS_VERSION 5
+
+typedef struct __attribute__((__packed__)) {
+	uint8_t version;
+	uint8_t backgroundColor;
+	uint8_t handColor;
+	uint8_t handBorderColor;
+	uint8_t dotColor;
+	uint8_t hourColor;
+	uint8_t handBorderToggle;
+	uint8_t vibeToggle;
+	uint8_t vibeStartTime;
+	uint8_t vibeEndTime;
+	uint8_t hourFormat;
+	uint8_t dateToggle;
+	uint8_t digTimeToggle;
+	uint8_t btAlertToggle;
+	uint8_t smoothMotion; // version 2
+	uint8_t chimePattern; // version 3
+	uint8_t quietHours[QUIET_HOURS_SIZE]; // version 3
+	uint8_t nightMode; // version 4
+	uint8_t quietHoursSet; // version 5
+} StoredSettings;
+
+#define SETTINGS_V1_SIZE offsetof(StoredSettings, smoothMotion)
+
+#ifdef MACRO_CLOCK_DEBUG
+// Counts persist_* calls made while a layer is drawing. The render path must
+// never touch storage, so anything but zero is logged as an error, once for
+// the frame that made them.
+static bool s_rendering;
+static int s_render_persist_calls;
+
+#define COUNT_PERSIST(call) ((s_rendering ? s_render_persist_calls++ : 0), (call))
+#define persist_exists(key) COUNT_PERSIST(persist_exists(key))
+#define persist_read_string(key, buf, size) COUNT_PERSIST(persist_read_string(key, buf, size))
+#define persist_read_bool(key) COUNT_PERSIST(persist_read_bool(key))
+#define persist_read_int(key) COUNT_PERSIST(persist_read_int(key))
+#define persist_write_string(key, str) COUNT_PERSIST(persist_write_string(key, str))
+#define persist_write_bool(key, value) COUNT_PERSIST(persist_write_bool(key, value))
+#define persist_write_int(key, value) COUNT_PERSIST(persist_write_int(key, value))
+#define persist_read_data(key, buf, size) COUNT_PERSIST(persist_read_data(key, buf, size))
+#define persist_write_data(key, buf, size) COUNT_PERSIST(persist_write_data(key, buf, size))
+#define persist_delete(key) COUNT_PERSIST(persist_delete(key))
+#define persist_get_size(key) COUNT_PERSIST(persist_get_size(key))
+
+#define RENDER_BEGIN() (s_rendering = true)
+#define RENDER_END() do { \
+		s_rendering = false; \
+		if (s_render_persist_calls > 0) { \
+			APP_LOG(APP_LOG_LEVEL_ERROR, "render path made %d persist calls", s_render_persist_calls); \
+			s_render_persist_calls = 0; \
+		} \
+	} while (0)
+
+// Memory instrumentation. LOG_MEMORY prints one "MEM" line of key=value pairs
+// that the emulator log can be scraped for. The stack depth of update_time and
+// the dial layer callback is measured by painting the stack below the caller
+// with a pattern on entry and finding the deepest overwritten byte on exit.
+// Painting starts STACK_PAINT_GAP below the instrumented function's frame
+// address, which has to clear its locals and the painting helper itself.
+#define STACK_PAINT_BYTES 1024
+#define STACK_PAINT_GAP 256
+#define STACK_PATTERN 0xA5
+
+enum StackSites {
+	SS_UPDATE_TIME = 0,
+	SS_DIAL_LAYER = 1,
+	SS_COUNT = 2
+};
+
+static int s_stack_peak[SS_COUNT];
+static size_t s_heap_peak;
+
+static __attribute__((noinline)) void paintStack(void * frame) {
+	volatile uint8_t *base = (uint8_t *) frame - STACK_PAINT_GAP;
+	for (int i = 1; i <= STACK_PAINT_BYTES; i++) {
+		base[-i] = STACK_PATTERN;
 	}
 }
 
-static int getToggleInt(char* intString) {
-	if (intString[0] == '0') {
-		return 0;
-	}
-	else if (intString[0] == '1') {
-		return 1;
+// Depth below the frame the paint started from, in bytes
+static __attribute__((noinline)) void measureStack(void * frame, int site) {
+	volatile uint8_t *base = (uint8_t *) frame - STACK_PAINT_GAP;
+	int depth = STACK_PAINT_GAP;
+	for (int i = STACK_PAINT_BYTES; i > 0; i--) {
+		if (base[-i] != STACK_PATTERN) {
+			depth += i;
+			break;
+		}
 	}
-	else if (intString[0] == '2') {
-		return 2;
+	if (depth > s_stack_peak[site]) {
+		s_stack_peak[site] = depth;
 	}
-	else {
-		APP_LOG(APP_LOG_LEVEL_DEBUG, "getToggleInt() returned invalid value: %s", intString);
-		return -1;
+	if (depth >= STACK_PAINT_GAP + STACK_PAINT_BYTES) {
+		APP_LOG(APP_LOG_LEVEL_WARNING, "stack site %d ran past the painted %d bytes", site, STACK_PAINT_BYTES);
 	}
-		
 }
 
-static GColor getColor(char* colorString) {
-	if (strcmp(colorString, "blk") == 0) {
-		return GColorBlack;
+static void logMemory(const char * where) {
+	size_t used = heap_bytes_used();
+	if (used > s_heap_peak) {
+		s_heap_peak = used;
+	}
+	APP_LOG(APP_LOG_LEVEL_INFO, "MEM at=%s heap_used=%d heap_free=%d heap_peak=%d stack_update_time=%d stack_dial_layer=%d",
+		where, (int) used, (int) heap_bytes_free(), (int) s_heap_peak,
+		s_stack_peak[SS_UPDATE_TIME], s_stack_peak[SS_DIAL_LAYER]);
+}
+
+#define LOG_MEMORY(where) logMemory(where)
+#define STACK_PAINT() paintStack(__builtin_frame_address(0))
+#define STACK_MEASURE(site) measureStack(__builtin_frame_address(0), site)
+#else
+#define RENDER_BEGIN()
+#define RENDER_END()
+#define LOG_MEMORY(where)
+#define STACK_PAINT()
+#define STACK_MEASURE(site)
+#endif
+
+#ifdef MACRO_CLOCK_PROFILE
+// Handler timings. Every probe records its duration in a per-site ring of the
+// last PROFILE_SAMPLES runs; a triple tap logs min, avg, max and a histogram
+// for each site as one "PROF" line. Durations are in PROFILE_UNIT.
+#define PROFILE_SAMPLES 32
+#define PROFILE_TAP_WINDOW_MS 1500
+
+enum ProfileSites {
+	PS_TICK = 0,
+	PS_DIAL_LAYER = 1,
+	PS_TAP = 2,
+	PS_CONFIG = 3,
+	PS_COUNT = 4
+};
+
+static const char * const PROFILE_NAMES[PS_COUNT] = { "tick", "dial_layer", "tap", "config" };
+
+// Upper bounds, in ms, of all but the last histogram bucket
+static const uint16_t PROFILE_BUCKETS[] = { 1, 4, 9, 19, 49 };
+#define PROFILE_BUCKET_COUNT (ARRAY_LENGTH(PROFILE_BUCKETS) + 1)
+
+static uint16_t s_profile_samples[PS_COUNT][PROFILE_SAMPLES];
+static uint8_t s_profile_next[PS_COUNT];
+static uint8_t s_profile_count[PS_COUNT];
+static uint32_t s_profile_taps[3];
+
+#ifdef MACRO_CLOCK_HOST
+// The host harness runs on simulated time, which stands still inside a
+// handler, so its probes read the real clock. Handlers take well under a
+// millisecond there and are timed in microseconds.
+#define PROFILE_UNIT "us"
+#define PROFILE_UNITS_PER_MS 1000
+
+static uint32_t profileNow() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32_t) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+#else
+#define PROFILE_UNIT "ms"
+#define PROFILE_UNITS_PER_MS 1
+
+static uint32_t profileNow() {
+	time_t seconds;
+	uint16_t ms;
+	time_ms(&seconds, &ms);
+	return (uint32_t) seconds * 1000 + ms;
+}
+#endif
+
+static void profileRecord(int site, uint32_t start) {
+	uint32_t elapsed = profileNow() - start;
+	s_profile_samples[site][s_profile_next[site]] = elapsed > UINT16_MAX ? UINT16_MAX : elapsed;
+	s_profile_next[site] = (s_profile_next[site] + 1) % PROFILE_SAMPLES;
+	if (s_profile_count[site] < PROFILE_SAMPLES) {
+		s_profile_count[site]++;
 	}
-	else if (strcmp(colorString, "wht") == 0) {
-		return GColorWhite;
+}
+
+static void profileReport() {
+	for (int site = 0; site < PS_COUNT; site++) {
+		int count = s_profile_count[site];
+		uint32_t total = 0;
+		uint16_t min = UINT16_MAX;
+		uint16_t max = 0;
+		uint8_t histogram[PROFILE_BUCKET_COUNT] = { 0 };
+		for (int i = 0; i < count; i++) {
+			uint16_t sample = s_profile_samples[site][i];
+			total += sample;
+			min = sample < min ? sample : min;
+			max = sample > max ? sample : max;
+			unsigned int bucket = 0;
+			while (bucket < ARRAY_LENGTH(PROFILE_BUCKETS) && sample > PROFILE_BUCKETS[bucket] * PROFILE_UNITS_PER_MS) {
+				bucket++;
+			}
+			histogram[bucket]++;
+		}
+		APP_LOG(APP_LOG_LEVEL_INFO, "PROF %s unit=%s n=%d min=%d avg=%d max=%d hist=%d/%d/%d/%d/%d/%d",
+			PROFILE_NAMES[site], PROFILE_UNIT, count, count ? min : 0, count ? (int) (total / count) : 0, max,
+			histogram[0], histogram[1], histogram[2], histogram[3], histogram[4], histogram[5]);
 	}
-	else if (strcmp(colorString, "red") == 0) {
-		return GColorRed;
+}
+
+// Three taps within PROFILE_TAP_WINDOW_MS print the report
+static void profileTap() {
+	s_profile_taps[0] = s_profile_taps[1];
+	s_profile_taps[1] = s_profile_taps[2];
+	s_profile_taps[2] = profileNow();
+	if (s_profile_taps[0] && s_profile_taps[2] - s_profile_taps[0] <= PROFILE_TAP_WINDOW_MS * PROFILE_UNITS_PER_MS) {
+		profileReport();
+		memset(s_profile_taps, 0, sizeof(s_profile_taps));
 	}
-	else if (strcmp(colorString, "org") == 0) {
-		return GColorOrange;
+}
+
+#define PROFILE_BEGIN() uint32_t profileStart = profileNow()
+#define PROFILE_END(site) profileRecord(site, profileStart)
+#define PROFILE_TAP() profileTap()
+#else
+#define PROFILE_BEGIN()
+#define PROFILE_END(site)
+#define PROFILE_TAP()
+#endif
+
+// Clock angles run clockwise from 12 o'clock, dial angles counter-clockwise
+// from 3 o'clock like the unit circle.
+static int32_t getDialAngle(int32_t clockAngle) {
+	return (TRIG_MAX_ANGLE / 4) - clockAngle;
+}
+
+static int32_t getTableCos(int32_t dialAngle) {
+	// Everything on the dial at rest sits on a whole half degree, so rounding to the nearest entry is exact
+	int32_t angle = dialAngle & (TRIG_MAX_ANGLE - 1);
+	int32_t index = (angle * GEOMETRY_STEPS + (TRIG_MAX_ANGLE / 2)) / TRIG_MAX_ANGLE;
+	int32_t offGrid = angle * GEOMETRY_STEPS - index * TRIG_MAX_ANGLE;
+	if (offGrid < -16 * GEOMETRY_STEPS || offGrid > 16 * GEOMETRY_STEPS) {
+		// Only frames of a smooth hand glide land in between
+		return (int32_t) (((int64_t) cos_lookup(angle) * (GEOMETRY_RADIUS << GEOMETRY_SHIFT)) / TRIG_MAX_RATIO);
+	}
+	return GEOMETRY_COS[index % GEOMETRY_STEPS];
+}
+
+static int32_t getTableSin(int32_t dialAngle) {
+	return getTableCos(dialAngle - (TRIG_MAX_ANGLE / 4));
+}
+
+// Position of the point at pointAngle on the big circle, relative to the point
+// at timeAngle which is pinned to origin. Rounds to the nearest pixel.
+static GPoint getDialPoint(int32_t pointAngle, int32_t timeAngle, int originX, int originY) {
+	return GPoint(
+		(getTableCos(pointAngle) - getTableCos(timeAngle) + (originX << GEOMETRY_SHIFT) + (GEOMETRY_SCALE / 2)) >> GEOMETRY_SHIFT,
+		(getTableSin(timeAngle) - getTableSin(pointAngle) + (originY << GEOMETRY_SHIFT) + (GEOMETRY_SCALE / 2)) >> GEOMETRY_SHIFT);
+}
+
+
+// "08a" is 8, "12a" is noon and "11p" is 23. Anything else gives -1.
+static int getHourInt(const char* hourString) {
+	if ((hourString[0] != '0' && hourString[0] != '1') ||
+	   hourString[1] < '0' || hourString[1] > '9' ||
+	   (hourString[2] != 'a' && hourString[2] != 'p') || hourString[3] != '\0') {
+		return -1;
 	}
-	else if (strcmp(colorString, "ylw") == 0) {
-		return GColorYellow;
+	
+	int toReturn = (hourString[0] - '0') * 10 + (hourString[1] - '0');
+	if (hourString[2] == 'p') {
+		toReturn += 12;
 	}
-	else if (strcmp(colorString, "grn") == 0) {
-		return GColorDarkGreen;
+	return toReturn <= 23 ? toReturn : -1;
+}
+
+#ifdef PBL_BW
+// Black and white screens show every color as black or white by brightness.
+// A color that is not the background but would vanish into it shows as the
+// other one, so a red hand on black stays visible.
+static GColor getBWColor(GColor color) {
+	int red = (color.argb >> 4) & 3;
+	int green = (color.argb >> 2) & 3;
+	int blue = color.argb & 3;
+	return (3 * red + 6 * green + blue) >= 15 ? GColorWhite : GColorBlack;
+}
+
+static GColor getDisplayColor(GColor color) {
+	GColor background = getBWColor(s_settings.backgroundColor);
+	GColor shown = getBWColor(color);
+	if (color.argb != s_settings.backgroundColor.argb && gcolor_equal(shown, background)) {
+		return gcolor_equal(background, GColorBlack) ? GColorWhite : GColorBlack;
 	}
-	else if (strcmp(colorString, "ble") == 0) {
-		return GColorDukeBlue;
+	return shown;
+}
+#else
+#define getDisplayColor(color) (color)
+#endif
+
+// The three-letter codes the configuration pages used to send, which the
+// per-key settings still hold.
+static const struct {
+	char code[4];
+	uint8_t argb;
+} LEGACY_COLORS[] = {
+	{ "blk", GColorBlackARGB8 },
+	{ "wht", GColorWhiteARGB8 },
+	{ "red", GColorRedARGB8 },
+	{ "org", GColorOrangeARGB8 },
+	{ "ylw", GColorYellowARGB8 },
+	{ "grn", GColorDarkGreenARGB8 },
+	{ "ble", GColorDukeBlueARGB8 },
+	{ "prp", GColorImperialPurpleARGB8 },
+	{ "pnk", GColorShockingPinkARGB8 },
+	{ "gry", GColorDarkGrayARGB8 }
+};
+
+// ARGB8 value of a legacy color code, -1 for anything else
+static int getColor(const char* colorString) {
+	for (unsigned int i = 0; i < ARRAY_LENGTH(LEGACY_COLORS); i++) {
+		if (strcmp(colorString, LEGACY_COLORS[i].code) == 0) {
+			return LEGACY_COLORS[i].argb;
+		}
 	}
-	else if (strcmp(colorString, "prp") == 0) {
-		return GColorImperialPurple;
+	return -1;
+}
+
+static void packSettings(StoredSettings *stored, const Settings *settings) {
+	stored->version = SETTINGS_VERSION;
+	stored->backgroundColor = settings->backgroundColor.argb;
+	stored->handColor = settings->handColor.argb;
+	stored->handBorderColor = settings->handBorderColor.argb;
+	stored->dotColor = settings->dotColor.argb;
+	stored->hourColor = settings->hourColor.argb;
+	stored->handBorderToggle = settings->handBorderToggle;
+	stored->vibeToggle = settings->vibeToggle;
+	stored->vibeStartTime = settings->vibeStartTime;
+	stored->vibeEndTime = settings->vibeEndTime;
+	stored->hourFormat = settings->hourFormat;
+	stored->dateToggle = settings->dateToggle;
+	stored->digTimeToggle = settings->digTimeToggle;
+	stored->btAlertToggle = settings->btAlertToggle;
+	stored->smoothMotion = settings->smoothMotion;
+	stored->chimePattern = settings->chimePattern;
+	memcpy(stored->quietHours, settings->quietHours.bits, QUIET_HOURS_SIZE);
+	stored->nightMode = settings->nightMode;
+	stored->quietHoursSet = settings->quietHoursSet;
+}
+
+static void unpackSettings(const StoredSettings *stored) {
+	s_settings.backgroundColor = (GColor) { .argb = stored->backgroundColor };
+	s_settings.handColor = (GColor) { .argb = stored->handColor };
+	s_settings.handBorderColor = (GColor) { .argb = stored->handBorderColor };
+	s_settings.dotColor = (GColor) { .argb = stored->dotColor };
+	s_settings.hourColor = (GColor) { .argb = stored->hourColor };
+	s_settings.handBorderToggle = stored->handBorderToggle;
+	s_settings.vibeToggle = stored->vibeToggle;
+	// A corrupted blob falls back to the defaults of whatever is out of range
+	s_settings.vibeStartTime = stored->vibeStartTime < 24 ? stored->vibeStartTime : 8;
+	s_settings.vibeEndTime = stored->vibeEndTime < 24 ? stored->vibeEndTime : 23;
+	s_settings.hourFormat = stored->hourFormat;
+	s_settings.dateToggle = stored->dateToggle <= DT_ALWAYS_ON ? stored->dateToggle : DT_FLICK;
+	s_settings.digTimeToggle = stored->digTimeToggle <= DT_ALWAYS_ON ? stored->digTimeToggle : DT_FLICK;
+	s_settings.btAlertToggle = stored->btAlertToggle;
+	s_settings.smoothMotion = stored->smoothMotion;
+	s_settings.chimePattern = stored->chimePattern < CP_COUNT ? stored->chimePattern : CP_DOUBLE;
+	QuietHours chimeWindow;
+	quietHoursFromChimeWindow(&chimeWindow, s_settings.vibeStartTime, s_settings.vibeEndTime);
+	if (stored->version >= 3) {
+		memcpy(s_settings.quietHours.bits, stored->quietHours, QUIET_HOURS_SIZE);
 	}
-	else if (strcmp(colorString, "pnk") == 0) {
-		return GColorShockingPink;
+	else {
+		s_settings.quietHours = chimeWindow;
 	}
-	else if (strcmp(colorString, "gry") == 0) {
-		return GColorDarkGray;
+	// Before version 5 only a mask that differs from the chime window can
+	// have come from MK_QUIET_HOURS
+	if (stored->version >= 5) {
+		s_settings.quietHoursSet = stored->quietHoursSet != 0;
 	}
 	else {
-		APP_LOG(APP_LOG_LEVEL_DEBUG, "getColor received an invalid string: %s", colorString);
-		return GColorWhite;
+		s_settings.quietHoursSet = memcmp(&s_settings.quietHours, &chimeWindow, sizeof(chimeWindow)) != 0;
+	}
+	s_settings.nightMode = stored->nightMode;
+}
+
+// One flash write for the whole configuration
+static void saveSettings() {
+	StoredSettings stored;
+	packSettings(&stored, &s_settings);
+	persist_write_data(PK_SETTINGS, &stored, sizeof(stored));
+}
+
+// Compares the stored form, which has no padding to trip over
+static bool settingsEqual(const Settings *a, const Settings *b) {
+	StoredSettings storedA;
+	StoredSettings storedB;
+	packSettings(&storedA, a);
+	packSettings(&storedB, b);
+	return memcmp(&storedA, &storedB, sizeof(StoredSettings)) == 0;
+}
+
+// Applies one pair of an MK_CONFIG message. Colors are GColor ARGB8 bytes,
+// hours 0-23, the date lines take a DateToggle, the chime a ChimePattern and
+// everything else is 0 or 1.
+static void applySetting(uint8_t key, uint8_t value) {
+	switch (key) {
+		case MK_BACKGROUND_COLOR:
+			s_settings.backgroundColor = (GColor) { .argb = value };
+			break;
+		case MK_HOUR_COLOR:
+			s_settings.hourColor = (GColor) { .argb = value };
+			break;
+		case MK_HAND_COLOR:
+			s_settings.handColor = (GColor) { .argb = value };
+			break;
+		case MK_DOT_COLOR:
+			s_settings.dotColor = (GColor) { .argb = value };
+			break;
+		case MK_HAND_OUTLINE_COLOR:
+			s_settings.handBorderColor = (GColor) { .argb = value };
+			break;
+		case MK_HAND_OUTLINE_BOOL:
+			s_settings.handBorderToggle = value != 0;
+			break;
+		case MK_VIBE_TOGGLE:
+			s_settings.vibeToggle = value != 0;
+			break;
+		case MK_HOUR_FORMAT:
+			s_settings.hourFormat = value != 0;
+			break;
+		case MK_VIBE_START:
+			if (value < 24) {
+				s_settings.vibeStartTime = value;
+				quietHoursFromChimeWindow(&s_settings.quietHours, s_settings.vibeStartTime, s_settings.vibeEndTime);
+				s_settings.quietHoursSet = false;
+			}
+			break;
+		case MK_VIBE_END:
+			if (value < 24) {
+				s_settings.vibeEndTime = value;
+				quietHoursFromChimeWindow(&s_settings.quietHours, s_settings.vibeStartTime, s_settings.vibeEndTime);
+				s_settings.quietHoursSet = false;
+			}
+			break;
+		case MK_CHIME_PATTERN:
+			if (value < CP_COUNT) {
+				s_settings.chimePattern = value;
+			}
+			break;
+		case MK_DATE_TOGGLE:
+			if (value <= DT_ALWAYS_ON) {
+				s_settings.dateToggle = value;
+			}
+			break;
+		case MK_DIG_TIME_TOGGLE:
+			if (value <= DT_ALWAYS_ON) {
+				s_settings.digTimeToggle = value;
+			}
+			break;
+		case MK_BT_ALERT_TOGGLE:
+			s_settings.btAlertToggle = value != 0;
+			break;
+		case MK_SMOOTH_MOTION:
+			s_settings.smoothMotion = value != 0;
+			break;
+		case MK_NIGHT_MODE:
+			s_settings.nightMode = value != 0;
+			break;
+		default:
+			APP_LOG(APP_LOG_LEVEL_DEBUG, "unknown setting %d", key);
+			break;
 	}
 }
 
+// The phone sees a dropped message as a NACK and sends it again
 void in_dropped_handler(AppMessageResult reason, void *ctx) {
     APP_LOG(APP_LOG_LEVEL_DEBUG, "Message Dropped: %d", reason);
 }
 
-static void top_line_layer_update_callback(Layer *layer, GContext *ctx) {
-	graphics_context_set_stroke_color(ctx, handColor);
-	gpath_draw_outline(ctx, topLinePath);
+// Frame of the numeral `hours` hours after hourAngle with the hand at pathAngle
+static GRect getNumeralFrame(int32_t hourAngle, int32_t pathAngle, int hours) {
+	GPoint pos = getDialPoint(getDialAngle(hourAngle) - hours * DIAL_HOUR, getDialAngle(pathAngle),
+		midWidth, midHeight);
+	//xPos-5 and width=60 because "20" doesn't fit in 50x50 apparently.
+	return GRect(pos.x-5, pos.y, 60, 50);
 }
 
-static void bot_line_layer_update_callback(Layer *layer, GContext *ctx) {
-	graphics_context_set_stroke_color(ctx, handColor);
-	gpath_draw_outline(ctx, botLinePath);
+static void drawNumerals(GContext *ctx) {
+	GRect hourFrame = s_layout.hourFrame;
+	GRect nextHourFrame = s_layout.nextHourFrame;
+	if (s_hand_angle != s_layout.pathAngle) {
+		hourFrame = getNumeralFrame(s_layout.hourAngle, s_hand_angle, 0);
+		nextHourFrame = getNumeralFrame(s_layout.hourAngle, s_hand_angle, 1);
+	}
+	
+	graphics_context_set_text_color(ctx, getDisplayColor(s_settings.hourColor));
+	graphics_draw_text(ctx, s_layout.hour, s_numeral_font, hourFrame,
+		GTextOverflowModeWordWrap, GTextAlignmentCenter, NULL);
+	graphics_draw_text(ctx, s_layout.nextHour, s_numeral_font, nextHourFrame,
+		GTextOverflowModeWordWrap, GTextAlignmentCenter, NULL);
 }
 
-// Layer update callback which is called on render updates
-static void path_layer_update_callback(Layer *layer, GContext *ctx) {
-	// Getting the current time
-	time_t tempTime = time(NULL);
-	struct tm * timeStruct = localtime(&tempTime);
-
-	s_path_angle = (((timeStruct->tm_hour % 12) * 60) + timeStruct->tm_min) * 360 / (12 * 60);
-
-	gpath_rotate_to(s_line_path, (TRIG_MAX_ANGLE / 360) * s_path_angle);
-	
-	//I don't know what's happening anymore I need to refactor literally everything
-	//Goddamn C/PebbleSDK and its obscured memory management
-	if (persist_exists(MK_HAND_OUTLINE_COLOR)) {
-		char why[4];
-		persist_read_string(MK_HAND_OUTLINE_COLOR, why, sizeof(why));
-		if (strcmp(why, "nob") == 0) {
-			handBorderToggle = false;
-			handBorderColor = GColorBlack;
-		} else {
-			handBorderToggle = true;
-			handBorderColor = getColor(why);
+static void drawDots(GContext *ctx) {
+	graphics_context_set_stroke_color(ctx, getDisplayColor(s_settings.dotColor));
+	graphics_context_set_fill_color(ctx, getDisplayColor(s_settings.dotColor));
+	
+	int32_t timeAngle = getDialAngle(s_hand_angle);
+	int32_t hourAngle = getDialAngle(s_layout.hourAngle);
+	
+	// Three dots between each pair of numerals, 7.5 degrees apart, the middle
+	// one bigger. Below the full tier only the middle one is left.
+	for (int hour = 0; hour < 3; hour++) {
+		for (int step = 1; step <= 3; step++) {
+			if (s_tier != RT_FULL && step != 2) {
+				continue;
+			}
+			GPoint dot = getDialPoint(hourAngle - (hour * DIAL_HOUR - step * DIAL_DOT_STEP), timeAngle,
+				screenMidWidth, screenMidHeight);
+			graphics_fill_circle(ctx, dot, step == 2 ? 5 : 3);
 		}
 	}
-	else {
-		handBorderToggle = true;
-		handBorderColor = GColorBlack;
-	}
-	
-	graphics_context_set_stroke_color(ctx, handBorderColor);
-	graphics_context_set_fill_color(ctx, handColor);
+}
+
+// The hand is rotated by update_time, so drawing never has to look at the clock.
+static void drawHand(GContext *ctx) {
+	graphics_context_set_stroke_color(ctx, getDisplayColor(s_settings.handBorderColor));
+	graphics_context_set_fill_color(ctx, getDisplayColor(s_settings.handColor));
 	gpath_draw_filled(ctx, s_line_path);	
-	if (handBorderToggle) {
+	if (s_settings.handBorderToggle && s_tier == RT_FULL) {
 		gpath_draw_outline(ctx, s_line_path);
 	}
 }
 
-static void dot_layer_update_callback(Layer *layer, GContext *ctx) {
-		
-	graphics_context_set_stroke_color(ctx, dotColor);
-	graphics_context_set_fill_color(ctx, dotColor);
-	
-	time_t tempTime = time(NULL);
-	struct tm * tick_time = localtime(&tempTime);
-	
-	s_path_angle = (((tick_time->tm_hour % 12) * 60) + tick_time->tm_min) / 2;
-	s_path_angle_adj_rad = -(s_path_angle * M_PI / 180) + (M_PI / 2);
-	
-	s_hour_angle = (((tick_time->tm_hour % 12) * 60)) / 2;
-	s_hour_angle_adj_rad = -(s_hour_angle * M_PI / 180) + (M_PI / 2);
-	
-	if (s_path_angle_adj_rad > (M_PI / 2) &&
-	   s_path_angle_adj_rad < (3 * M_PI / 2)) {
-		s_path_angle_adj_rad += (2 * M_PI);	
+// Each separator line shows and hides together with its date line
+static void drawSeparators(GContext *ctx) {
+	graphics_context_set_stroke_color(ctx, getDisplayColor(s_settings.handColor));
+	if (!layer_get_hidden(dateLayer)) {
+		gpath_draw_outline(ctx, topLinePath);
 	}
-	
-	if (s_hour_angle_adj_rad > (M_PI / 2) &&
-	   s_hour_angle_adj_rad < (3 * M_PI / 2)) {
-		s_hour_angle_adj_rad += (2 * M_PI);	
+	if (!layer_get_hidden(dateLayer2)) {
+		gpath_draw_outline(ctx, botLinePath);
 	}
-		
-	double timeX = getCos(s_path_angle_adj_rad) * radius;	
-	double timeY = getSin(s_path_angle_adj_rad) * radius;
-		
-	double preDotX = getCos(s_hour_angle_adj_rad - ((0 * M_PI / 6) - (M_PI / 24))) * radius;
-	double preDotX2 = getCos(s_hour_angle_adj_rad - ((0 * M_PI / 6) - (2 * M_PI / 24))) * radius;
-	double preDotX3 = getCos(s_hour_angle_adj_rad - ((0 * M_PI / 6) - (3 * M_PI / 24))) * radius;
-		
-	double preDotY = getSin(s_hour_angle_adj_rad - ((0 * M_PI / 6) - (M_PI / 24))) * radius;
-	double preDotY2 = getSin(s_hour_angle_adj_rad - ((0 * M_PI / 6) - (2 * M_PI / 24))) * radius;
-	double preDotY3 = getSin(s_hour_angle_adj_rad - ((0 * M_PI / 6) - (3 * M_PI / 24))) * radius;
-		
-	double postDotX = getCos(s_hour_angle_adj_rad - ((M_PI / 6) - (M_PI / 24))) * radius;
-	double postDotX2 = getCos(s_hour_angle_adj_rad - ((M_PI / 6) - (2 * M_PI / 24))) * radius;
-	double postDotX3 = getCos(s_hour_angle_adj_rad - ((M_PI / 6) - (3 * M_PI / 24))) * radius;
-		
-	double postDotY = getSin(s_hour_angle_adj_rad - ((M_PI / 6) - (M_PI / 24))) * radius;
-	double postDotY2 = getSin(s_hour_angle_adj_rad - ((M_PI / 6) - (2 * M_PI / 24))) * radius;
-	double postDotY3 = getSin(s_hour_angle_adj_rad - ((M_PI / 6) - (3 * M_PI / 24))) * radius;	
-	double postPostDotX = getCos(s_hour_angle_adj_rad - ((2 * M_PI / 6) - (M_PI / 24))) * radius;
-	double postPostDotX2 = getCos(s_hour_angle_adj_rad - ((2 * M_PI / 6) - (2 * M_PI / 24))) * radius;
-	double postPostDotX3 = getCos(s_hour_angle_adj_rad - ((2 * M_PI / 6) - (3 * M_PI / 24))) * radius;
-	double postPostDotY = getSin(s_hour_angle_adj_rad - ((2 * M_PI / 6) - (M_PI / 24))) * radius;
-	double postPostDotY2 = getSin(s_hour_angle_adj_rad - ((2 * M_PI / 6) - (2 * M_PI / 24))) * radius;
-	double postPostDotY3 = getSin(s_hour_angle_adj_rad - ((2 * M_PI / 6) - (3 * M_PI / 24))) * radius;
-		
-	struct GPoint preDot1, 
-		preDot2, 
-		preDot3, 
-		postDot1, 
-		postDot2, 
-		postDot3, 
-		postPostDot1, 
-		postPostDot2, 
-		postPostDot3;
-	
-	preDot1.x = (preDotX - timeX) + screenMidWidth;
-	preDot1.y = (timeY - preDotY) + screenMidHeight;
-	
-	preDot2.x = (preDotX2 - timeX) + screenMidWidth;
-	preDot2.y = (timeY - preDotY2) + screenMidHeight;
-	
-	preDot3.x = (preDotX3 - timeX) + screenMidWidth;
-	preDot3.y = (timeY - preDotY3) + screenMidHeight;
-	
-	postDot1.x = (postDotX - timeX) + screenMidWidth;
-	postDot1.y = (timeY - postDotY) + screenMidHeight;
-	
-	postDot2.x = (postDotX2 - timeX) + screenMidWidth;
-	postDot2.y = (timeY - postDotY2) + screenMidHeight;
-	
-	postDot3.x = (postDotX3 - timeX) + screenMidWidth;
-	postDot3.y = (timeY - postDotY3) + screenMidHeight;
-	
-	postPostDot1.x = (postPostDotX - timeX) + screenMidWidth;
-	postPostDot1.y = (timeY - postPostDotY) + screenMidHeight;
-	
-	postPostDot2.x = (postPostDotX2 - timeX) + screenMidWidth;
-	postPostDot2.y = (timeY - postPostDotY2) + screenMidHeight;
-	
-	postPostDot3.x = (postPostDotX3 - timeX) + screenMidWidth;
-	postPostDot3.y = (timeY - postPostDotY3) + screenMidHeight;
-	
-	graphics_fill_circle(ctx, preDot1, 3);
-	graphics_fill_circle(ctx, preDot2, 5);	
-	graphics_fill_circle(ctx, preDot3, 3);
-	graphics_fill_circle(ctx, postDot1, 3);
-	graphics_fill_circle(ctx, postDot2, 5);	
-	graphics_fill_circle(ctx, postDot3, 3);
-	graphics_fill_circle(ctx, postPostDot1, 3);
-	graphics_fill_circle(ctx, postPostDot2, 5);	
-	graphics_fill_circle(ctx, postPostDot3, 3);
 }
 
-static void update_time() {		
-	time_t tempTime = time(NULL);
-	struct tm * tick_time = localtime(&tempTime);
-	int currHour = tick_time->tm_hour;
-	
-	strftime(dateBuffer, sizeof(dateBuffer), "%a, %b %e", tick_time);
-		
-	if (hourFormat) {
-		strftime(buffer, sizeof("00"), "%H", tick_time);
-		strftime(dateBuffer2, sizeof("00:00"), "%H:%M", tick_time);
-	}
-	else {
-		strftime(buffer, sizeof("00"), "%I", tick_time);
-		strftime(dateBuffer2, sizeof("00:00 XX"), "%l:%M %p", tick_time);
+// For changes the (hour, angle) key does not see: colors and the hour format
+static void invalidateDialCache() {
+	s_dial_cache_valid = false;
+}
+
+static bool isDialCacheCurrent() {
+	return s_dial_cache && s_dial_cache_valid &&
+		s_cache_path_angle == s_hand_angle && s_cache_hour_angle == s_layout.hourAngle;
+}
+
+// Copies what has been drawn so far, background, numerals and dots, into the cache
+static void saveDialCache(GContext *ctx) {
+	GBitmap *frameBuffer = graphics_capture_frame_buffer(ctx);
+	if (!frameBuffer) {
+		return;
+	}
+	
+	uint8_t *dst = gbitmap_get_data(s_dial_cache);
+	uint16_t dstRow = gbitmap_get_bytes_per_row(s_dial_cache);
+	int rows = gbitmap_get_bounds(s_dial_cache).size.h;
+#ifdef PBL_ROUND
+	// Round frame buffers only store the visible span of each row
+	for (int y = 0; y < rows; y++) {
+		GBitmapDataRowInfo row = gbitmap_get_data_row_info(frameBuffer, y);
+		int maxX = row.max_x < dstRow - 1 ? row.max_x : dstRow - 1;
+		if (maxX >= row.min_x) {
+			memcpy(dst + y * dstRow + row.min_x, row.data + row.min_x, maxX - row.min_x + 1);
+		}
 	}
-		
-	s_path_angle = (((tick_time->tm_hour % 12) * 60) + tick_time->tm_min) / 2;
-	s_path_angle_adj_rad = -(s_path_angle * M_PI / 180) + (M_PI / 2);
-	
-	s_hour_angle = (((tick_time->tm_hour % 12) * 60)) / 2;
-	s_hour_angle_adj_rad = -(s_hour_angle * M_PI / 180) + (M_PI / 2);
-	
-	if (s_path_angle_adj_rad > (M_PI / 2) &&
-	   s_path_angle_adj_rad < (3 * M_PI / 2)) {
-		s_path_angle_adj_rad += (2 * M_PI);	
+#else
+	// Whole rows, which also covers the 1-bit aplite frame buffer
+	uint8_t *src = gbitmap_get_data(frameBuffer);
+	uint16_t srcRow = gbitmap_get_bytes_per_row(frameBuffer);
+	uint16_t rowSize = srcRow < dstRow ? srcRow : dstRow;
+	for (int y = 0; y < rows; y++) {
+		memcpy(dst + y * dstRow, src + y * srcRow, rowSize);
 	}
+#endif
+	graphics_release_frame_buffer(ctx, frameBuffer);
 	
-	if (s_hour_angle_adj_rad > (M_PI / 2) &&
-	   s_hour_angle_adj_rad < (3 * M_PI / 2)) {
-		s_hour_angle_adj_rad += (2 * M_PI);	
-	}
+	s_dial_cache_valid = true;
+	s_cache_path_angle = s_hand_angle;
+	s_cache_hour_angle = s_layout.hourAngle;
+}
+
+// Layer update callback which is called on render updates. Draws the whole dial
+// in one pass, bottom to top: numerals, dots, hand, separator lines.
+static void dial_layer_update_callback(Layer *layer, GContext *ctx) {
+	PROFILE_BEGIN();
+	STACK_PAINT();
+	RENDER_BEGIN();
 	
-	if (tick_time->tm_hour == 23) {
-		tick_time->tm_hour = 0;
-	}
-	else {
-		tick_time->tm_hour++;
+	if (s_night) {
+		// Drawn once an hour, so there is nothing to gain from the cache
+		drawNumerals(ctx);
+		RENDER_END();
+		STACK_MEASURE(SS_DIAL_LAYER);
+		PROFILE_END(PS_DIAL_LAYER);
+		return;
 	}
 	
-	if (hourFormat) {
-		strftime(buffer2, sizeof("00"), "%H", tick_time);
+	if (isDialCacheCurrent()) {
+		graphics_draw_bitmap_in_rect(ctx, s_dial_cache, layer_get_bounds(layer));
 	}
 	else {
-		strftime(buffer2, sizeof("00"), "%I", tick_time);
-	}
-				
-	double timeX = getCos(s_path_angle_adj_rad) * radius;	
-	double timeY = getSin(s_path_angle_adj_rad) * radius;
-	double hourX = getCos(s_hour_angle_adj_rad) * radius;
-	double hourY = getSin(s_hour_angle_adj_rad) * radius;
-	
-	double hourX2 = getCos(s_hour_angle_adj_rad - (0.5236)) * radius;
-	double hourY2 = getSin(s_hour_angle_adj_rad - (0.5236)) * radius;
-	
-	int xPos = -(timeX - hourX) + midWidth;
-	int yPos = -(hourY - timeY) + midHeight;
-	
-	int xPos2 = -(timeX - hourX2) + midWidth;
-	int yPos2 = -(hourY2 - timeY) + midHeight;
-	
-	//xPos-5 and width=60 because "20" doesn't fit in 50x50 apparently.
-	layer_set_frame(timeLayer, GRect(xPos-5,yPos,60,50));
-	layer_set_frame(timeLayer2, GRect(xPos2-5,yPos2,60,50));
-		
-	char * bufferS = buffer+1;
-	char * buffer2S = buffer2+1;
-	
-	if (hourFormat) {
-		if (currHour > 9) {
-			text_layer_set_text(s_time_layer, buffer);
-			if (currHour == 23) {
-				text_layer_set_text(s_time_layer2, buffer2S);
-			}
-			else {
-				text_layer_set_text(s_time_layer2, buffer2);
-			}
-		}
-		else {
-			text_layer_set_text(s_time_layer, bufferS);
-			
-			if (currHour == 9) {
-				text_layer_set_text(s_time_layer2, buffer2);
-			}
-			else {
-				text_layer_set_text(s_time_layer2, buffer2S);
-			}
-		}
-	}
-	else {
-		if (currHour > 0 && currHour < 10) {
-			text_layer_set_text(s_time_layer, bufferS);
-		}
-		else if (currHour > 12 && currHour < 22) {
-			text_layer_set_text(s_time_layer, bufferS);
+		drawNumerals(ctx);
+		if (s_tier != RT_MINIMAL) {
+			drawDots(ctx);
 		}
-		else {
-			text_layer_set_text(s_time_layer, buffer);
-		}
-
-		if (currHour >= 0 && currHour < 9) {
-			text_layer_set_text(s_time_layer2, buffer2S);
-		}
-		else if (currHour >= 12 && currHour < 21) {
-			text_layer_set_text(s_time_layer2, buffer2S);
-		}
-		else {
-			text_layer_set_text(s_time_layer2, buffer2);
-		}
-	}
-	
-	if (tick_time->tm_min == 0) {
-		if (vibeToggle) {
-			if (vibeEndTime < vibeStartTime) {
-				if (currHour >= vibeStartTime || currHour <= vibeEndTime) {
-					vibes_double_pulse();
-				}
-			}
-			else {	
-				if (currHour >= vibeStartTime && currHour <= vibeEndTime) {
-		    		vibes_double_pulse();
-				}
-			}
+		// Glide frames are never drawn twice, so they are not worth copying
+		if (s_dial_cache && !s_hand_animation) {
+			saveDialCache(ctx);
 		}
 	}
+	drawHand(ctx);
+	drawSeparators(ctx);
 	
-	text_layer_set_text(s_date_layer, dateBuffer);
-	text_layer_set_text(s_date_layer2, dateBuffer2);
-	
-	layer_mark_dirty(timeLayer);
-	layer_mark_dirty(timeLayer2);
-	layer_mark_dirty(dateLayer);
-	layer_mark_dirty(dateLayer2);
-			
-	gpath_rotate_to(s_line_path, (TRIG_MAX_ANGLE / 360) * s_path_angle);
-	layer_mark_dirty(s_path_layer);	
+	RENDER_END();
+	STACK_MEASURE(SS_DIAL_LAYER);
+	PROFILE_END(PS_DIAL_LAYER);
 }
 
-static void tick_handler(struct tm *tick_time, TimeUnits units_changed) {
-	update_time();
+// Takes ownership of what handle points at. A failed create leaves it NULL,
+// which the teardown skips.
+static void own(ResourceKind kind, void ** handle) {
+	if (s_owned_count == MAX_OWNED_RESOURCES) {
+		APP_LOG(APP_LOG_LEVEL_ERROR, "resource table full");
+		return;
+	}
+	s_owned[s_owned_count++] = (OwnedResource) { .kind = kind, .handle = handle };
 }
 
-static void hideDate(void *data) {
-	layer_set_hidden(data, true);
+static void destroyOwned() {
+	while (s_owned_count > 0) {
+		OwnedResource *resource = &s_owned[--s_owned_count];
+		if (*resource->handle) {
+			switch (resource->kind) {
+				case RK_LAYER:
+					layer_destroy(*resource->handle);
+					break;
+				case RK_TEXT_LAYER:
+					text_layer_destroy(*resource->handle);
+					break;
+				case RK_GBITMAP:
+					gbitmap_destroy(*resource->handle);
+					break;
+				case RK_GPATH:
+					gpath_destroy(*resource->handle);
+					break;
+			}
+			*resource->handle = NULL;
+		}
+	}
 }
 
-
-static void tap_handler(AccelAxisType axis, int32_t direction) {
-	if (dateToggle == DT_FLICK) {
-		layer_set_hidden(dateLayer, false);
-		layer_set_hidden(topPathLayer, false);
-		app_timer_register(3500, hideDate, dateLayer);
-		app_timer_register(3500, hideDate, topPathLayer);
+static void computeLayout(const struct tm * tick_time, const Settings * settings, DialLayout * layout) {
+	formatDate(layout->date, tick_time);
+	formatDigitalTime(layout->digitalTime, tick_time, settings->hourFormat);
+	formatNumeral(layout->hour, tick_time->tm_hour, settings->hourFormat);
+	formatNumeral(layout->nextHour, tick_time->tm_hour + 1, settings->hourFormat);
+	
+	// The hand steps a whole degree every other minute, or half a degree every
+	// minute in smooth mode where the glide makes the small steps visible
+	int minutes = ((tick_time->tm_hour % 12) * 60) + tick_time->tm_min;
+	if (settings->smoothMotion) {
+		layout->pathAngle = TRIG_MAX_ANGLE * minutes / 720;
 	}
+	else {
+		layout->pathAngle = TRIG_MAX_ANGLE * (minutes / 2) / 360;
+	}
+	layout->hourAngle = DIAL_HOUR * (tick_time->tm_hour % 12);
 	
-	if (digTimeToggle == DT_FLICK) {
-		layer_set_hidden(dateLayer2, false);
-		layer_set_hidden(botPathLayer, false);
-		app_timer_register(3500, hideDate, dateLayer2);	
-		app_timer_register(3500, hideDate, botPathLayer);
-	}	
+	layout->hourFrame = getNumeralFrame(layout->hourAngle, layout->pathAngle, 0);
+	layout->nextHourFrame = getNumeralFrame(layout->hourAngle, layout->pathAngle, 1);
 }
 
-static void bt_handler(bool connected) {
-	if (btAlertToggle) {
-		if (!connected) {
-			vibes_long_pulse();
-		}
+// Moves the hand, and the dial with it, to angle and redraws
+static void showHandAngle(int32_t angle) {
+	if (angle != s_hand_angle) {
+		s_hand_angle = angle;
+		gpath_rotate_to(s_line_path, s_hand_angle);
+		layer_mark_dirty(s_dial_layer);
 	}
 }
 
-static void in_received_handler(DictionaryIterator *received, void *ctx) {	
-	Tuple *currDictItem = dict_read_first(received);
-	while (currDictItem) {		
-		if (currDictItem->key == MK_BACKGROUND_COLOR) {
-			backgroundColor = getColor(currDictItem->value->cstring);
-			persist_write_string(MK_BACKGROUND_COLOR, currDictItem->value->cstring);
-		} 
-		else if (currDictItem->key == MK_HOUR_COLOR) {
-			hourColor = getColor(currDictItem->value->cstring);
-			persist_write_string(MK_HOUR_COLOR, currDictItem->value->cstring);
-		}
-		else if (currDictItem->key == MK_HAND_COLOR) {
-			handColor = getColor(currDictItem->value->cstring);
-			persist_write_string(MK_HAND_COLOR, currDictItem->value->cstring);
-		}
-		else if (currDictItem->key == MK_DOT_COLOR) {
-			dotColor = getColor(currDictItem->value->cstring);
-			persist_write_string(MK_DOT_COLOR, currDictItem->value->cstring);
-		}
-		else if (currDictItem->key == MK_HAND_OUTLINE_COLOR) {
-			if (strcmp(currDictItem->value->cstring, "nob") == 0) {
-				handBorderColor = GColorWhite;
-				handBorderToggle = false;
-				persist_write_string(MK_HAND_OUTLINE_COLOR, "wht");
-				persist_write_bool(MK_HAND_OUTLINE_BOOL, handBorderToggle);
-			}
-			else {
-				handBorderColor = getColor(currDictItem->value->cstring);
-				handBorderToggle = true;
-				persist_write_string(MK_HAND_OUTLINE_COLOR, currDictItem->value->cstring);
-				persist_write_bool(MK_HAND_OUTLINE_BOOL, handBorderToggle);
-			}
-		}
-		else if (currDictItem->key == MK_VIBE_TOGGLE) {
-			if (strcmp(currDictItem->value->cstring, "onn") == 0) {
-				vibeToggle = true;
-				persist_write_bool(MK_VIBE_TOGGLE, true);
-			}
-			else {
-				vibeToggle = false;
-				persist_write_bool(MK_VIBE_TOGGLE, false);
-			}
-		}
-		else if (currDictItem->key == MK_HOUR_FORMAT) {
-			if (strcmp(currDictItem->value->cstring, "24h") == 0) {
-				hourFormat = true;
-				persist_write_bool(MK_HOUR_FORMAT, true);
-			}
-			else {
-				hourFormat = false;
-				persist_write_bool(MK_HOUR_FORMAT, false);
-			}
-		}
-		else if (currDictItem->key == MK_VIBE_START) {
-			vibeStartTime = getHourInt(currDictItem->value->cstring);
-			persist_write_string(MK_VIBE_START, currDictItem->value->cstring);
-		}
-		else if (currDictItem->key == MK_VIBE_END) {
-			vibeEndTime = getHourInt(currDictItem->value->cstring);
-			persist_write_string(MK_VIBE_END, currDictItem->value->cstring);
-		}
-		else if (currDictItem->key == MK_DATE_TOGGLE) {
-			dateToggle = getToggleInt(currDictItem->value->cstring);
-			persist_write_int(MK_DATE_TOGGLE, dateToggle);
-		}
-		else if (currDictItem->key == MK_DIG_TIME_TOGGLE) {
-			digTimeToggle = getToggleInt(currDictItem->value->cstring);
-			persist_write_int(MK_DIG_TIME_TOGGLE, digTimeToggle);
-		}
-		else if (currDictItem->key == MK_BT_ALERT_TOGGLE) {
-			if (strcmp(currDictItem->value->cstring, "onn") == 0) {
-				btAlertToggle = true;
-				persist_write_bool(MK_BT_ALERT_TOGGLE, true);
-			}
-			else {
-				btAlertToggle = false;
-				persist_write_bool(MK_BT_ALERT_TOGGLE, false);
-			}
-		}
-		else {
-			APP_LOG(APP_LOG_LEVEL_DEBUG, "default!, %d", (int) currDictItem->key);
-		}
-		
-		currDictItem = dict_read_next(received);
+static void hand_animation_update(Animation *animation, const AnimationProgress progress) {
+	// Progress is quantized to SMOOTH_FRAMES steps, which is what caps the frame rate
+	int frame = (int) (((int64_t) progress * SMOOTH_FRAMES) / ANIMATION_NORMALIZED_MAX);
+	if (frame == s_anim_frame) {
+		return;
 	}
+	s_anim_frame = frame;
 	
-	if (dateToggle == DT_ALWAYS_ON) {
-		layer_set_hidden(dateLayer, false);
-		layer_set_hidden(topPathLayer, false);
+	if (s_smooth_frames >= SMOOTH_FRAME_BUDGET) {
+		frame = SMOOTH_FRAMES;
 	}
 	else {
-		layer_set_hidden(dateLayer, true);
-		layer_set_hidden(topPathLayer, true);
+		s_smooth_frames++;
 	}
-		
-	if (digTimeToggle == DT_ALWAYS_ON) {
-		layer_set_hidden(dateLayer2, false);
-		layer_set_hidden(botPathLayer, false);
+	showHandAngle(s_anim_from_angle + (s_layout.pathAngle - s_anim_from_angle) * frame / SMOOTH_FRAMES);
+}
+
+static void hand_animation_stopped(Animation *animation, bool finished, void *context) {
+	// The system destroys the animation once stopped. Cut short, the caller
+	// decides where the hand goes next.
+	s_hand_animation = NULL;
+	if (finished) {
+		showHandAngle(s_layout.pathAngle);
 	}
-	else {
-		layer_set_hidden(dateLayer2, true);
-		layer_set_hidden(botPathLayer, true);
-	}
-	
-	window_set_background_color(s_main_window, backgroundColor);
-	text_layer_set_background_color(s_time_layer, backgroundColor);
-	text_layer_set_background_color(s_time_layer2, backgroundColor);
-	text_layer_set_background_color(s_date_layer, backgroundColor);
-	text_layer_set_background_color(s_date_layer2, backgroundColor);
-	text_layer_set_text_color(s_date_layer, hourColor);
-	text_layer_set_text_color(s_date_layer2, hourColor);
-	text_layer_set_text_color(s_time_layer, hourColor);
-	text_layer_set_text_color(s_time_layer2, hourColor);
-	
-	layer_mark_dirty(timeLayer);
-	layer_mark_dirty(timeLayer2);
-	layer_mark_dirty(s_dot_layer);
-	layer_mark_dirty(s_path_layer);	
-	layer_mark_dirty(dateLayer);
-	layer_mark_dirty(dateLayer2);
-	layer_mark_dirty(topPathLayer);
-	layer_mark_dirty(botPathLayer);
-	update_time();
 }
 
-static void main_window_load(Window *window) {		
-	time_t tempTime = time(NULL);
-	struct tm * tick_time = localtime(&tempTime);
-	int currHour = tick_time->tm_hour;
-	
-	strftime(dateBuffer, sizeof(dateBuffer), "%a, %b %e", tick_time);
-		
-	if (hourFormat) {
-		strftime(buffer, sizeof("00"), "%H", tick_time);
-		strftime(dateBuffer2, sizeof("00:00"), "%H:%M", tick_time);
+static const AnimationImplementation HAND_ANIMATION_IMPL = {
+	.update = hand_animation_update
+};
+
+static bool canGlide(const struct tm * tick_time) {
+	if (tick_time->tm_hour != s_smooth_budget_hour) {
+		s_smooth_budget_hour = tick_time->tm_hour;
+		s_smooth_frames = 0;
 	}
-	else {
-		strftime(buffer, sizeof("00"), "%I", tick_time);
-		strftime(dateBuffer2, sizeof("00:00 XX"), "%l:%M %p", tick_time);
+	return s_settings.smoothMotion && s_smooth_frames < SMOOTH_FRAME_BUDGET && s_tier == RT_FULL;
+}
+
+// Takes the hand from wherever it is shown to s_layout.pathAngle
+static void moveHand(const struct tm * tick_time) {
+	if (s_hand_animation) {
+		animation_unschedule(s_hand_animation);
+	}
+	
+	// Going backwards, settings changes and 12 o'clock all just snap
+	int32_t delta = s_layout.pathAngle - s_hand_angle;
+	if (delta > 0 && delta <= TRIG_MAX_ANGLE / 360 && canGlide(tick_time)) {
+		s_hand_animation = animation_create();
+		if (s_hand_animation) {
+			s_anim_from_angle = s_hand_angle;
+			s_anim_frame = 0;
+			animation_set_duration(s_hand_animation, SMOOTH_DURATION_MS);
+			animation_set_curve(s_hand_animation, AnimationCurveEaseOut);
+			animation_set_implementation(s_hand_animation, &HAND_ANIMATION_IMPL);
+			animation_set_handlers(s_hand_animation, (AnimationHandlers) {
+				.stopped = hand_animation_stopped
+			}, NULL);
+			animation_schedule(s_hand_animation);
+			return;
+		}
 	}
-	
-	s_path_angle = (((tick_time->tm_hour % 12) * 60) + tick_time->tm_min) / 2;
-	s_path_angle_adj_rad = -(s_path_angle * M_PI / 180) + (M_PI / 2);
-	
-	s_hour_angle = (((tick_time->tm_hour % 12) * 60)) / 2;
-	s_hour_angle_adj_rad = -(s_hour_angle * M_PI / 180) + (M_PI / 2);
-		
-	if (s_path_angle_adj_rad > (M_PI / 2) &&
-	   s_path_angle_adj_rad < (3 * M_PI / 2)) {
-		s_path_angle_adj_rad += (2 * M_PI);	
+	showHandAngle(s_layout.pathAngle);
+}
+
+// Redraws a layer whose content changed. Hidden layers are skipped, unhiding redraws them anyway.
+static void markChanged(Layer * layer) {
+	if (!layer_get_hidden(layer)) {
+		layer_mark_dirty(layer);
 	}
-	
-	if (s_hour_angle_adj_rad > (M_PI / 2) &&
-	   s_hour_angle_adj_rad < (3 * M_PI / 2)) {
-		s_hour_angle_adj_rad += (2 * M_PI);	
+}
+
+// The dial layer draws the separator line for each date line, so it is redrawn with it
+static void setDateHidden(Layer * layer, bool hidden) {
+	if (layer_get_hidden(layer) != hidden) {
+		layer_set_hidden(layer, hidden);
+		layer_mark_dirty(s_dial_layer);
 	}
-	
-	if (tick_time->tm_hour == 23) {
-		tick_time->tm_hour = 0;
+}
+
+static void tick_handler(struct tm *tick_time, TimeUnits units_changed);
+
+// Resubscribing replaces the old subscription, so only a real change is passed on
+static void setTickUnit(TimeUnits unit) {
+	if (unit != s_tick_unit) {
+		s_tick_unit = unit;
+		tick_timer_service_subscribe(unit, tick_handler);
 	}
-	else {
-		tick_time->tm_hour++;
-	}	
-		
-	if (hourFormat) {
-		strftime(buffer2, sizeof("00"), "%H", tick_time);
+}
+
+static bool isNightTime(const struct tm * tick_time) {
+	return s_settings.nightMode && time(NULL) >= s_night_wake_until &&
+		quietHoursContains(&s_settings.quietHours, tick_time->tm_wday, tick_time->tm_hour);
+}
+
+// Neither date line would stay current between hourly ticks
+static bool isHourly() {
+	return s_night || s_tier == RT_MINIMAL;
+}
+
+static void showDateLines() {
+	setDateHidden(dateLayer, isHourly() || s_settings.dateToggle != DT_ALWAYS_ON);
+	setDateHidden(dateLayer2, isHourly() || s_settings.digTimeToggle != DT_ALWAYS_ON);
+}
+
+// Switches between night, the battery tiers and the full face. The layers
+// stay as they are; only what the dial draws and the tick unit change.
+static void setFaceMode(bool night, RenderTier tier) {
+	bool wasHourly = isHourly();
+	if (tier != s_tier) {
+		invalidateDialCache();
 	}
-	else {
-		strftime(buffer2, sizeof("00"), "%I", tick_time);
+	if (night != s_night || tier != s_tier) {
+		layer_mark_dirty(s_dial_layer);
 	}
+	s_night = night;
+	s_tier = tier;
 	
-	double timeX = getCos(s_path_angle_adj_rad) * radius;		
-	double timeY = getSin(s_path_angle_adj_rad) * radius;
-		
-	double hourX = getCos(s_hour_angle_adj_rad) * radius;
-	double hourY = getSin(s_hour_angle_adj_rad) * radius;
-			
-	double hourX2 = getCos(s_hour_angle_adj_rad - (M_PI / 6)) * radius;
-	double hourY2 = getSin(s_hour_angle_adj_rad - (M_PI / 6)) * radius;
-	
-	int xPos = (hourX - timeX) + midWidth;
-	int yPos = (timeY - hourY) + midHeight;
-	
-	int xPos2 = (hourX2 - timeX) + midWidth;
-	int yPos2 = (timeY - hourY2) + midHeight;
-	
-	char * bufferS = buffer+1;
-	char * buffer2S = buffer2+1;
-			
-	s_time_layer = text_layer_create(GRect(xPos-5, yPos, 60, 50));
-	text_layer_set_background_color(s_time_layer, backgroundColor);
-	text_layer_set_text_color(s_time_layer, hourColor);
-
-	s_time_layer2 = text_layer_create(GRect(xPos2-5, yPos2, 60, 50));
-	text_layer_set_background_color(s_time_layer2, backgroundColor);
-	text_layer_set_text_color(s_time_layer2, hourColor);
-	
-	s_date_layer = text_layer_create(GRect(0, 0, 144, 24));
-	text_layer_set_background_color(s_date_layer, backgroundColor);
-	text_layer_set_text_color(s_date_layer, hourColor);
-	text_layer_set_text(s_date_layer, dateBuffer);
-	
-	s_date_layer2 = text_layer_create(GRect(0, 144, 144, 24));
-	text_layer_set_background_color(s_date_layer2, backgroundColor);
-	text_layer_set_text_color(s_date_layer2, hourColor);
-	text_layer_set_text(s_date_layer2, dateBuffer2);
-
-		
-	if (hourFormat) {
-		if (currHour > 9) {
-			text_layer_set_text(s_time_layer, buffer);
-			if (tick_time->tm_hour == 0) {
-				text_layer_set_text(s_time_layer2, buffer2S);
-			}
-			else {
-				text_layer_set_text(s_time_layer2, buffer2);
-			}
-		}
-		else {
-			text_layer_set_text(s_time_layer, bufferS);
-			
-			if (currHour == 9) {
-				text_layer_set_text(s_time_layer2, buffer2);
-			}
-			else {
-				text_layer_set_text(s_time_layer2, buffer2S);
-			}
-		}
+	// Quiet hours are whole hours, so the hourly tick arrives right when night ends
+	setTickUnit(isHourly() ? HOUR_UNIT : MINUTE_UNIT);
+	if (isHourly() != wasHourly) {
+		showDateLines();
 	}
-	else {
-		if (currHour > 0 && currHour < 10) {
-			text_layer_set_text(s_time_layer, bufferS);
-		}
-		else if (currHour > 12 && currHour < 22) {
-			text_layer_set_text(s_time_layer, bufferS);
-		}
-		else {
-			text_layer_set_text(s_time_layer, buffer);
-		}
+}
 
-		if (currHour >= 0 && currHour < 9) {
-			text_layer_set_text(s_time_layer2, buffer2S);
-		}
-		else if (currHour >= 12 && currHour < 21) {
-			text_layer_set_text(s_time_layer2, buffer2S);
-		}
-		else {
-			text_layer_set_text(s_time_layer2, buffer2);
-		}
-	}
-			
-	Layer *window_layer = window_get_root_layer(window);
-	GRect bounds = layer_get_frame(window_layer);
-	
-	text_layer_set_font(s_time_layer, fonts_get_system_font(FONT_KEY_BITHAM_42_BOLD));
-	text_layer_set_text_alignment(s_time_layer, GTextAlignmentCenter);
-		
-	text_layer_set_font(s_time_layer2, fonts_get_system_font(FONT_KEY_BITHAM_42_BOLD));
-	text_layer_set_text_alignment(s_time_layer2, GTextAlignmentCenter);
-	
-	text_layer_set_font(s_date_layer, fonts_get_system_font(FONT_KEY_ROBOTO_CONDENSED_21));
-	text_layer_set_text_alignment(s_date_layer, GTextAlignmentCenter);
-	
-	text_layer_set_font(s_date_layer2, fonts_get_system_font(FONT_KEY_ROBOTO_CONDENSED_21));
-	text_layer_set_text_alignment(s_date_layer2, GTextAlignmentCenter);
-	
-	s_dot_layer = layer_create(bounds);
-	layer_set_update_proc(s_dot_layer, dot_layer_update_callback);
-	
-	s_path_layer = layer_create(bounds);
-	layer_set_update_proc(s_path_layer, path_layer_update_callback);
+// Only layers whose text or geometry actually changed since the last call are invalidated.
+// On most ticks that is the digital time alone, and nothing at all on odd minutes when it is hidden.
+static void update_time(struct tm * tick_time) {		
+	STACK_PAINT();
 	
-	topPathLayer = layer_create(bounds);
-	layer_set_update_proc(topPathLayer, top_line_layer_update_callback);
+	setFaceMode(isNightTime(tick_time), s_tier);
 	
-	botPathLayer = layer_create(bounds);
-	layer_set_update_proc(botPathLayer, bot_line_layer_update_callback);
+	DialLayout layout;
+	computeLayout(tick_time, &s_settings, &layout);
 	
-	layer_add_child(window_get_root_layer(window), text_layer_get_layer(s_time_layer));		
-	layer_add_child(window_get_root_layer(window), text_layer_get_layer(s_time_layer2));
+	bool dateChanged = strcmp(layout.date, s_layout.date) != 0;
+	bool digitalTimeChanged = strcmp(layout.digitalTime, s_layout.digitalTime) != 0;
+	bool handMoved = layout.pathAngle != s_layout.pathAngle;
+	bool numeralsChanged = strcmp(layout.hour, s_layout.hour) != 0 ||
+		strcmp(layout.nextHour, s_layout.nextHour) != 0 ||
+		!grect_equal(&layout.hourFrame, &s_layout.hourFrame) ||
+		!grect_equal(&layout.nextHourFrame, &s_layout.nextHourFrame);
 	
-	layer_add_child(window_layer, s_dot_layer);
-	layer_add_child(window_layer, s_path_layer);
-	
-	layer_add_child(window_get_root_layer(window), text_layer_get_layer(s_date_layer));
-	layer_add_child(window_get_root_layer(window), text_layer_get_layer(s_date_layer2));
+	s_layout = layout;
 	
+	if (dateChanged) {
+		markChanged(dateLayer);
+	}
+	if (digitalTimeChanged) {
+		markChanged(dateLayer2);
+	}
+	if (numeralsChanged) {
+		invalidateDialCache();
+	}
 	
-	layer_add_child(window_layer, topPathLayer);
-	layer_add_child(window_layer, botPathLayer);
+	if (handMoved) {
+		moveHand(tick_time);
+	}
+	if (numeralsChanged) {
+		layer_mark_dirty(s_dial_layer);
+	}
 	
-	// Move all paths to the center of the screen
-	gpath_move_to(s_line_path, GPoint(bounds.size.w/2, bounds.size.h/2));
+	STACK_MEASURE(SS_UPDATE_TIME);
 }
 
-static void main_window_unload(Window *window) {
-	layer_destroy(s_path_layer);
-	layer_destroy(s_dot_layer);
-	layer_destroy(topPathLayer);
-	layer_destroy(botPathLayer);
-	layer_destroy(timeLayer);
-	layer_destroy(timeLayer2);
-	layer_destroy(dateLayer);
-	layer_destroy(dateLayer2);
+// The chime goes with the tick that starts the hour, not with update_time,
+// which also runs on taps, tier changes and new settings
+static void tick_handler(struct tm *tick_time, TimeUnits units_changed) {
+	PROFILE_BEGIN();
+	update_time(tick_time);
+	if ((units_changed & HOUR_UNIT) && s_settings.vibeToggle &&
+	   !quietHoursContains(&s_settings.quietHours, tick_time->tm_wday, tick_time->tm_hour)) {
+		vibes_enqueue_custom_pattern(CHIME_PATTERNS[s_settings.chimePattern]);
+	}
+	PROFILE_END(PS_TICK);
 }
 
-static void init() {	
-	s_line_path = gpath_create(&LINE_PATH_POINTS);
-	topLinePath = gpath_create(&TOP_LINE_POINTS);
-	botLinePath = gpath_create(&BOT_LINE_POINTS);
-	
-	char * strBuffer = "000";
-	
-	if (persist_exists(MK_BACKGROUND_COLOR)) {
-		persist_read_string(MK_BACKGROUND_COLOR, strBuffer, sizeof(strBuffer));
-		backgroundColor = getColor(strBuffer);
+// Hides whatever a tap revealed. The separator lines go with their date lines.
+static void hideRevealed(void *data) {
+	s_reveal_timer = NULL;
+	if (s_settings.dateToggle == DT_FLICK) {
+		setDateHidden(dateLayer, true);
 	}
-	else {
-		backgroundColor = GColorBlack;
+	if (s_settings.digTimeToggle == DT_FLICK) {
+		setDateHidden(dateLayer2, true);
 	}
+}
+
+
+static void tap_handler(AccelAxisType axis, int32_t direction) {
+	PROFILE_BEGIN();
+	PROFILE_TAP();
 	
-	if (persist_exists(MK_HOUR_COLOR)) {
-		persist_read_string(MK_HOUR_COLOR, strBuffer, sizeof(strBuffer));
-		hourColor = getColor(strBuffer);
+	// A nearly flat battery stays on hourly ticks, and the date lines with it
+	if (s_night && s_tier != RT_MINIMAL) {
+		time_t now = time(NULL);
+		s_night_wake_until = now + NIGHT_WAKE_S;
+		update_time(localtime(&now));
 	}
-	else {
-		hourColor = GColorWhite;
+	if (isHourly()) {
+		PROFILE_END(PS_TAP);
+		return;
 	}
 	
-	if (persist_exists(MK_HAND_COLOR)) {
-		persist_read_string(MK_HAND_COLOR, strBuffer, sizeof(strBuffer));
-		handColor = getColor(strBuffer);
-	}
-	else {
-		handColor = GColorWhite;
+	bool revealed = false;
+	if (s_settings.dateToggle == DT_FLICK) {
+		setDateHidden(dateLayer, false);
+		revealed = true;
 	}
 	
-	if (persist_exists(MK_DOT_COLOR)) {
-		persist_read_string(MK_DOT_COLOR, strBuffer, sizeof(strBuffer));
-		dotColor = getColor(strBuffer);
-	}
-	else {
-		dotColor = GColorWhite;
+	if (s_settings.digTimeToggle == DT_FLICK) {
+		setDateHidden(dateLayer2, false);
+		revealed = true;
 	}
 	
-	if (persist_exists(MK_HAND_OUTLINE_COLOR)) {
-		persist_read_string(MK_HAND_OUTLINE_COLOR, strBuffer, sizeof(strBuffer));
-		handBorderColor = getColor(strBuffer);
-	}
-	else {
-		handBorderColor = GColorWhite;
+	// Every tap pushes the one timer back, so the lines stay up for REVEAL_MS after the last tap
+	if (revealed && !(s_reveal_timer && app_timer_reschedule(s_reveal_timer, REVEAL_MS))) {
+		s_reveal_timer = app_timer_register(REVEAL_MS, hideRevealed, NULL);
 	}
 	
-	if (persist_exists(MK_HAND_OUTLINE_BOOL)) {
-		handBorderToggle = persist_read_bool(MK_HAND_OUTLINE_BOOL);
+	PROFILE_END(PS_TAP);
+}
+
+static RenderTier getRenderTier(BatteryChargeState charge) {
+	if (charge.is_charging || charge.is_plugged || charge.charge_percent > TIER_REDUCED_BATTERY) {
+		return RT_FULL;
 	}
-	else {
-		handBorderToggle = true;
+	return charge.charge_percent > TIER_MINIMAL_BATTERY ? RT_REDUCED : RT_MINIMAL;
+}
+
+static void battery_handler(BatteryChargeState charge) {
+	RenderTier tier = getRenderTier(charge);
+	if (tier != s_tier) {
+		setFaceMode(s_night, tier);
+		// Back from hourly ticks the layout is up to an hour old
+		time_t now = time(NULL);
+		update_time(localtime(&now));
+	}
+}
+
+static void bt_handler(bool connected) {
+	if (s_settings.btAlertToggle && !connected) {
+		time_t now = time(NULL);
+		struct tm *local = localtime(&now);
+		if (!s_settings.quietHoursSet || !quietHoursContains(&s_settings.quietHours, local->tm_wday, local->tm_hour)) {
+			vibes_long_pulse();
+		}
 	}
+}
+
+static void applyConfigMessage(DictionaryIterator *received) {
+	Settings previous = s_settings;
 	
-	if (persist_exists(MK_VIBE_TOGGLE)) {
-		vibeToggle = persist_read_bool(MK_VIBE_TOGGLE);
+	Tuple *config = dict_find(received, MK_CONFIG);
+	if (config && config->type != TUPLE_BYTE_ARRAY) {
+		config = NULL;
 	}
-	else {
-		vibeToggle = false;
+	Tuple *quiet = dict_find(received, MK_QUIET_HOURS);
+	if (quiet && (quiet->type != TUPLE_BYTE_ARRAY || quiet->length != QUIET_HOURS_SIZE)) {
+		quiet = NULL;
+	}
+	if (!config && !quiet) {
+		APP_LOG(APP_LOG_LEVEL_DEBUG, "message without settings");
+		return;
 	}
 	
-	if (persist_exists(MK_HOUR_FORMAT)) {
-		hourFormat = persist_read_bool(MK_HOUR_FORMAT);
+	Tuple *seq = dict_find(received, MK_SEQ);
+	if (seq) {
+		if (s_has_seq && seq->value->int32 == s_last_seq) {
+			APP_LOG(APP_LOG_LEVEL_DEBUG, "settings chunk %d already applied", (int) s_last_seq);
+			return;
+		}
+		s_has_seq = true;
+		s_last_seq = seq->value->int32;
 	}
-	else {
-		hourFormat = false;
+	for (uint16_t i = 0; config && i + 1 < config->length; i += 2) {
+		applySetting(config->value->data[i], config->value->data[i + 1]);
 	}
-	
-	if (persist_exists(MK_VIBE_START)) {
-		persist_read_string(MK_VIBE_START, strBuffer, sizeof(strBuffer));
-		vibeStartTime = getHourInt(strBuffer);
+	// After the pairs, so the schedule wins over chime times sent alongside it
+	if (quiet) {
+		memcpy(s_settings.quietHours.bits, quiet->value->data, QUIET_HOURS_SIZE);
+		s_settings.quietHoursSet = true;
 	}
-	else {
-		vibeStartTime = 8;
+	
+	// The companion only sends what changed, but a pair can still repeat the
+	// current value; flash is only written when something really differs.
+	if (!settingsEqual(&previous, &s_settings)) {
+		saveSettings();
 	}
 	
-	if (persist_exists(MK_VIBE_END)) {
-		persist_read_string(MK_VIBE_END, strBuffer, sizeof(strBuffer));
-		vibeEndTime = getHourInt(strBuffer);
+	// Hiding, recoloring and retexting all invalidate on their own, so each is
+	// only done for what this message actually changed.
+	showDateLines();
+	
+	if (!gcolor_equal(previous.backgroundColor, s_settings.backgroundColor)) {
+		window_set_background_color(s_main_window, getDisplayColor(s_settings.backgroundColor));
+		text_layer_set_background_color(s_date_layer, getDisplayColor(s_settings.backgroundColor));
+		text_layer_set_background_color(s_date_layer2, getDisplayColor(s_settings.backgroundColor));
 	}
-	else {
-		vibeEndTime = 23;
+	
+	// On black and white screens the shown text color also depends on the background
+	if (!gcolor_equal(previous.hourColor, s_settings.hourColor) ||
+	   (PBL_IF_COLOR_ELSE(false, true) && !gcolor_equal(previous.backgroundColor, s_settings.backgroundColor))) {
+		text_layer_set_text_color(s_date_layer, getDisplayColor(s_settings.hourColor));
+		text_layer_set_text_color(s_date_layer2, getDisplayColor(s_settings.hourColor));
 	}
 	
-	if (persist_exists(MK_DATE_TOGGLE)) {
-		dateToggle = persist_read_int(MK_DATE_TOGGLE);
+	if (!gcolor_equal(previous.backgroundColor, s_settings.backgroundColor) ||
+	   !gcolor_equal(previous.hourColor, s_settings.hourColor) ||
+	   !gcolor_equal(previous.dotColor, s_settings.dotColor)) {
+		invalidateDialCache();
 	}
-	else {
-		dateToggle = 1;
+	
+	if (!gcolor_equal(previous.hourColor, s_settings.hourColor) ||
+	   !gcolor_equal(previous.handColor, s_settings.handColor) ||
+	   !gcolor_equal(previous.handBorderColor, s_settings.handBorderColor) ||
+	   previous.handBorderToggle != s_settings.handBorderToggle ||
+	   !gcolor_equal(previous.dotColor, s_settings.dotColor)) {
+		layer_mark_dirty(s_dial_layer);
 	}
 	
-	if (persist_exists(MK_DIG_TIME_TOGGLE)) {
-		digTimeToggle = persist_read_int(MK_DIG_TIME_TOGGLE);
+	// A new hour format shows up as changed text in update_time, night mode
+	// and new quiet hours as a new tick unit
+	time_t tempTime = time(NULL);
+	update_time(localtime(&tempTime));
+	
+	LOG_MEMORY("config");
+}
+
+static void in_received_handler(DictionaryIterator *received, void *ctx) {	
+	PROFILE_BEGIN();
+	applyConfigMessage(received);
+	PROFILE_END(PS_CONFIG);
+}
+
+static void main_window_load(Window *window) {		
+	Layer *window_layer = window_get_root_layer(window);
+	GRect bounds = layer_get_frame(window_layer);
+	
+	screenMidWidth = bounds.size.w / 2;
+	screenMidHeight = bounds.size.h / 2;
+	midWidth = screenMidWidth - 25;
+	midHeight = screenMidHeight - 25;
+	
+	time_t tempTime = time(NULL);
+	computeLayout(localtime(&tempTime), &s_settings, &s_layout);
+	
+	s_date_layer = text_layer_create(GRect(0, DATE_INSET, bounds.size.w, DATE_HEIGHT));
+	own(RK_TEXT_LAYER, (void **) &s_date_layer);
+	dateLayer = text_layer_get_layer(s_date_layer);
+	text_layer_set_background_color(s_date_layer, getDisplayColor(s_settings.backgroundColor));
+	text_layer_set_text_color(s_date_layer, getDisplayColor(s_settings.hourColor));
+	text_layer_set_text(s_date_layer, s_layout.date);
+	
+	s_date_layer2 = text_layer_create(GRect(0, bounds.size.h - DATE_INSET - DATE_HEIGHT, bounds.size.w, DATE_HEIGHT));
+	own(RK_TEXT_LAYER, (void **) &s_date_layer2);
+	dateLayer2 = text_layer_get_layer(s_date_layer2);
+	text_layer_set_background_color(s_date_layer2, getDisplayColor(s_settings.backgroundColor));
+	text_layer_set_text_color(s_date_layer2, getDisplayColor(s_settings.hourColor));
+	text_layer_set_text(s_date_layer2, s_layout.digitalTime);
+	
+	s_numeral_font = fonts_get_system_font(FONT_KEY_BITHAM_42_BOLD);
+	
+	text_layer_set_font(s_date_layer, fonts_get_system_font(FONT_KEY_ROBOTO_CONDENSED_21));
+	text_layer_set_text_alignment(s_date_layer, GTextAlignmentCenter);
+	
+	text_layer_set_font(s_date_layer2, fonts_get_system_font(FONT_KEY_ROBOTO_CONDENSED_21));
+	text_layer_set_text_alignment(s_date_layer2, GTextAlignmentCenter);
+	
+	s_dial_layer = layer_create(bounds);
+	own(RK_LAYER, (void **) &s_dial_layer);
+	layer_set_update_proc(s_dial_layer, dial_layer_update_callback);
+	
+	// If there is no room for the cache the dial is simply drawn every time.
+	// It has the frame buffer's format, so on aplite it is 1-bit and 3.4KB.
+	s_dial_cache = gbitmap_create_blank(bounds.size, PBL_IF_COLOR_ELSE(GBitmapFormat8Bit, GBitmapFormat1Bit));
+	own(RK_GBITMAP, (void **) &s_dial_cache);
+	s_dial_cache_valid = false;
+	
+	// The date lines sit on top of the dial so their background covers the hand
+	layer_add_child(window_layer, s_dial_layer);
+	layer_add_child(window_layer, dateLayer);
+	layer_add_child(window_layer, dateLayer2);
+	showDateLines();
+	
+	s_top_line_points[0] = GPoint(0, DATE_INSET + DATE_HEIGHT);
+	s_top_line_points[1] = GPoint(bounds.size.w, DATE_INSET + DATE_HEIGHT);
+	s_bot_line_points[0] = GPoint(0, bounds.size.h - DATE_INSET - DATE_HEIGHT - 1);
+	s_bot_line_points[1] = GPoint(bounds.size.w, bounds.size.h - DATE_INSET - DATE_HEIGHT - 1);
+	
+	s_line_path = gpath_create(&LINE_PATH_POINTS);
+	own(RK_GPATH, (void **) &s_line_path);
+	topLinePath = gpath_create(&TOP_LINE_POINTS);
+	own(RK_GPATH, (void **) &topLinePath);
+	botLinePath = gpath_create(&BOT_LINE_POINTS);
+	own(RK_GPATH, (void **) &botLinePath);
+	
+	// Move the hand to the center of the screen
+	gpath_move_to(s_line_path, GPoint(screenMidWidth, screenMidHeight));
+	s_hand_angle = s_layout.pathAngle;
+	gpath_rotate_to(s_line_path, s_hand_angle);
+	
+	LOG_MEMORY("load");
+}
+
+static void main_window_unload(Window *window) {
+	// The animation rotates s_line_path, so it has to stop before the path goes
+	if (s_hand_animation) {
+		animation_unschedule(s_hand_animation);
 	}
-	else {
-		digTimeToggle = 1;
+	destroyOwned();
+	dateLayer = NULL;
+	dateLayer2 = NULL;
+}
+
+static void setDefaultSettings() {
+	s_settings.backgroundColor = GColorBlack;
+	s_settings.hourColor = GColorWhite;
+	s_settings.handColor = GColorWhite;
+	s_settings.dotColor = GColorWhite;
+	s_settings.handBorderColor = GColorBlack;
+	s_settings.handBorderToggle = true;
+	s_settings.vibeToggle = false;
+	s_settings.hourFormat = false;
+	s_settings.vibeStartTime = 8;
+	s_settings.vibeEndTime = 23;
+	s_settings.chimePattern = CP_DOUBLE;
+	quietHoursFromChimeWindow(&s_settings.quietHours, s_settings.vibeStartTime, s_settings.vibeEndTime);
+	s_settings.quietHoursSet = false;
+	s_settings.dateToggle = DT_FLICK;
+	s_settings.digTimeToggle = DT_FLICK;
+	s_settings.btAlertToggle = false;
+	s_settings.smoothMotion = false;
+	s_settings.nightMode = false;
+}
+
+// How each MessageKeys entry was stored before the settings were packed into
+// PK_SETTINGS, one key per setting.
+typedef enum {
+	LK_COLOR,  // three-letter code string
+	LK_HOUR,   // "08a" style string
+	LK_BOOL,
+	LK_INT
+} LegacyKind;
+
+static const struct {
+	uint32_t key;
+	LegacyKind kind;
+} LEGACY_SCHEMA[] = {
+	{ MK_BACKGROUND_COLOR, LK_COLOR },
+	{ MK_HOUR_COLOR, LK_COLOR },
+	{ MK_HAND_COLOR, LK_COLOR },
+	{ MK_DOT_COLOR, LK_COLOR },
+	{ MK_HAND_OUTLINE_COLOR, LK_COLOR },
+	{ MK_VIBE_TOGGLE, LK_BOOL },
+	{ MK_HOUR_FORMAT, LK_BOOL },
+	{ MK_VIBE_START, LK_HOUR },
+	{ MK_VIBE_END, LK_HOUR },
+	{ MK_DATE_TOGGLE, LK_INT },
+	{ MK_DIG_TIME_TOGGLE, LK_INT },
+	{ MK_BT_ALERT_TOGGLE, LK_BOOL },
+	{ MK_HAND_OUTLINE_BOOL, LK_BOOL }
+};
+
+// Reads the old per-key settings over the defaults. A key only counts if its
+// stored size matches its kind and its value parses; everything else is
+// skipped. The value then goes through applySetting, which range-checks it.
+static void loadLegacySettings() {
+	setDefaultSettings();
+	
+	for (unsigned int i = 0; i < ARRAY_LENGTH(LEGACY_SCHEMA); i++) {
+		uint32_t key = LEGACY_SCHEMA[i].key;
+		if (!persist_exists(key)) {
+			continue;
+		}
+		
+		int size = persist_get_size(key);
+		char strBuffer[sizeof("000")];
+		int value = -1;
+		switch (LEGACY_SCHEMA[i].kind) {
+			case LK_COLOR:
+			case LK_HOUR:
+				if (size != sizeof(strBuffer)) {
+					break;
+				}
+				persist_read_string(key, strBuffer, sizeof(strBuffer));
+				value = LEGACY_SCHEMA[i].kind == LK_HOUR ? getHourInt(strBuffer) : getColor(strBuffer);
+				break;
+			case LK_BOOL:
+				if (size == sizeof(bool)) {
+					value = persist_read_bool(key);
+				}
+				break;
+			case LK_INT:
+				if (size == sizeof(int32_t)) {
+					int32_t stored = persist_read_int(key);
+					value = (stored >= 0 && stored <= UINT8_MAX) ? stored : -1;
+				}
+				break;
+		}
+		
+		if (value >= 0) {
+			applySetting(key, value);
+		}
+		else {
+			APP_LOG(APP_LOG_LEVEL_DEBUG, "ignoring stored key %d", (int) key);
+		}
 	}
-	
-	if (persist_exists(MK_BT_ALERT_TOGGLE)) {
-		btAlertToggle = persist_read_bool(MK_BT_ALERT_TOGGLE);
+}
+
+static void loadSettings() {
+	StoredSettings stored;
+	memset(&stored, 0, sizeof(stored));
+	int size = persist_read_data(PK_SETTINGS, &stored, sizeof(stored));
+	if (size >= (int) SETTINGS_V1_SIZE && stored.version >= 1 && stored.version <= SETTINGS_VERSION) {
+		unpackSettings(&stored);
+		if (stored.version != SETTINGS_VERSION) {
+			saveSettings();
+		}
+		return;
 	}
-	else {
-		btAlertToggle = false;
+	
+	// First launch, or first launch after an upgrade: migrate whatever the
+	// per-key layout holds into the blob and drop the old keys.
+	loadLegacySettings();
+	saveSettings();
+	for (uint32_t key = MK_BACKGROUND_COLOR; key <= MK_HAND_OUTLINE_BOOL; key++) {
+		persist_delete(key);
 	}
+}
+
+static void init() {	
+	loadSettings();
+	s_tier = getRenderTier(battery_state_service_peek());
 	
 	// Create Window
 	s_main_window = window_create();
-	window_set_background_color(s_main_window, backgroundColor);
+	window_set_background_color(s_main_window, getDisplayColor(s_settings.backgroundColor));
 	window_set_window_handlers(s_main_window, (WindowHandlers) {
 		.load = main_window_load,
 		.unload = main_window_unload,
@@ -937,68 +1480,38 @@ static void init() {
 	
 	window_stack_push(s_main_window, true);
 	
-	// Pass the corresponding GPathInfo to initialize a GPath
-	tick_timer_service_subscribe(MINUTE_UNIT, tick_handler);
+	// Subscribes to the tick unit for the current time
+	time_t now = time(NULL);
+	update_time(localtime(&now));
 	app_message_register_inbox_received(in_received_handler);
 	app_message_register_inbox_dropped(in_dropped_handler);
 	app_message_open(128, 128);
 	
-	timeLayer = text_layer_get_layer(s_time_layer);
-	timeLayer2 = text_layer_get_layer(s_time_layer2);
-	dateLayer = text_layer_get_layer(s_date_layer);
-	dateLayer2 = text_layer_get_layer(s_date_layer2);
-	
-	if (dateToggle == DT_ALWAYS_ON) {
-		layer_set_hidden(dateLayer, false);
-		layer_set_hidden(topPathLayer, false);
-	}
-	else {
-		layer_set_hidden(dateLayer, true);
-		layer_set_hidden(topPathLayer, true);
-	}
-		
-	if (digTimeToggle == DT_ALWAYS_ON) {
-		layer_set_hidden(dateLayer2, false);
-		layer_set_hidden(botPathLayer, false);
-	}
-	else {
-		layer_set_hidden(dateLayer2, true);
-		layer_set_hidden(botPathLayer, true);
-	}
-	
-	layer_insert_above_sibling(topPathLayer, dateLayer);
-	layer_insert_above_sibling(botPathLayer, dateLayer2);
-	
-	layer_mark_dirty(timeLayer);
-	layer_mark_dirty(timeLayer2);
-	layer_mark_dirty(s_dot_layer);
-	layer_mark_dirty(s_path_layer);	
-	layer_mark_dirty(topPathLayer);
-	layer_mark_dirty(botPathLayer);
-	layer_mark_dirty(dateLayer);
-	layer_mark_dirty(dateLayer2);
-	
 	accel_tap_service_subscribe(tap_handler);
 	bluetooth_connection_service_subscribe(bt_handler);
+	battery_state_service_subscribe(battery_handler);
 	
+	LOG_MEMORY("init");
 }
 
 static void deinit() {
+	if (s_reveal_timer) {
+		app_timer_cancel(s_reveal_timer);
+		s_reveal_timer = NULL;
+	}
 	window_destroy(s_main_window);
 
 	app_message_deregister_callbacks();
 	tick_timer_service_unsubscribe();
 	accel_tap_service_unsubscribe();
 	bluetooth_connection_service_unsubscribe();
-	
-	gpath_destroy(s_line_path);
-	gpath_destroy(topLinePath);
-	gpath_destroy(botLinePath);
+	battery_state_service_unsubscribe();
 }
 
 int main(void) {
 	init();
 	app_event_loop();
 	deinit();
+	return 0;
 }
 
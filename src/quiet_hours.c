@@ -0,0 +1,30 @@
+#include "quiet_hours.h"
+#include <string.h>
+
+#define WEEK_HOURS (7 * 24)
+
+static int getWeekHour(int wday, int hour) {
+	int weekHour = (wday * 24 + hour) % WEEK_HOURS;
+	return weekHour < 0 ? weekHour + WEEK_HOURS : weekHour;
+}
+
+bool quietHoursContains(const QuietHours * quiet, int wday, int hour) {
+	int weekHour = getWeekHour(wday, hour);
+	return (quiet->bits[weekHour >> 3] >> (weekHour & 7)) & 1;
+}
+
+void quietHoursAddWindow(QuietHours * quiet, int wday, int start, int end) {
+	int length = ((end - start) % 24 + 24) % 24;
+	int weekHour = getWeekHour(wday, start);
+	for (int i = 0; i < length; i++) {
+		quiet->bits[weekHour >> 3] |= 1 << (weekHour & 7);
+		weekHour = (weekHour + 1) % WEEK_HOURS;
+	}
+}
+
+void quietHoursFromChimeWindow(QuietHours * quiet, int start, int end) {
+	memset(quiet, 0, sizeof(*quiet));
+	for (int wday = 0; wday < 7; wday++) {
+		quietHoursAddWindow(quiet, wday, end + 1, start);
+	}
+}
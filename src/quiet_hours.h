@@ -0,0 +1,23 @@
+// Quiet hours: one bit for each hour of the week, Sunday 0:00 first. The
+// hourly chime and the disconnect alert stay silent in a set hour.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define QUIET_HOURS_SIZE (7 * 24 / 8)
+
+typedef struct {
+	uint8_t bits[QUIET_HOURS_SIZE];
+} QuietHours;
+
+// wday and hour as in struct tm
+bool quietHoursContains(const QuietHours * quiet, int wday, int hour);
+
+// Quiet from start on day wday up to, but not including, end. An end before
+// start runs on into the next day; start == end adds nothing.
+void quietHoursAddWindow(QuietHours * quiet, int wday, int start, int end);
+
+// The old single chime window: quiet every day outside start to end inclusive
+void quietHoursFromChimeWindow(QuietHours * quiet, int start, int end);
@@ -0,0 +1,72 @@
+#include "text_format.h"
+
+static const char DAY_NAMES[7][4] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+
+static const char MONTH_NAMES[12][4] = {
+	"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+	"Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+};
+
+// Out of range fields wrap instead of indexing past a table or a buffer
+static int wrap(int value, int range) {
+	value %= range;
+	return value < 0 ? value + range : value;
+}
+
+// Two digits of a value below 100. pad replaces a leading zero, '\0' drops it.
+static char * putTwoDigits(char * out, int value, char pad) {
+	if (value >= 10) {
+		*out++ = '0' + value / 10;
+	}
+	else if (pad) {
+		*out++ = pad;
+	}
+	*out++ = '0' + value % 10;
+	return out;
+}
+
+static char * putName(char * out, const char name[4]) {
+	*out++ = name[0];
+	*out++ = name[1];
+	*out++ = name[2];
+	return out;
+}
+
+static int get12Hour(int hour) {
+	hour = wrap(hour, 12);
+	return hour == 0 ? 12 : hour;
+}
+
+void formatNumeral(char numeral[TEXT_NUMERAL_SIZE], int hour, bool hourFormat) {
+	char *out = putTwoDigits(numeral, hourFormat ? wrap(hour, 24) : get12Hour(hour), '\0');
+	*out = '\0';
+}
+
+void formatDate(char date[TEXT_DATE_SIZE], const struct tm * time) {
+	char *out = putName(date, DAY_NAMES[wrap(time->tm_wday, 7)]);
+	*out++ = ',';
+	*out++ = ' ';
+	out = putName(out, MONTH_NAMES[wrap(time->tm_mon, 12)]);
+	*out++ = ' ';
+	out = putTwoDigits(out, wrap(time->tm_mday, 100), ' ');
+	*out = '\0';
+}
+
+void formatDigitalTime(char digitalTime[TEXT_TIME_SIZE], const struct tm * time, bool hourFormat) {
+	int hour = wrap(time->tm_hour, 24);
+	char *out;
+	if (hourFormat) {
+		out = putTwoDigits(digitalTime, hour, '0');
+	}
+	else {
+		out = putTwoDigits(digitalTime, get12Hour(hour), ' ');
+	}
+	*out++ = ':';
+	out = putTwoDigits(out, wrap(time->tm_min, 60), '0');
+	if (!hourFormat) {
+		*out++ = ' ';
+		*out++ = hour < 12 ? 'A' : 'P';
+		*out++ = 'M';
+	}
+	*out = '\0';
+}
@@ -0,0 +1,21 @@
+// Text for the face: hour numerals, the date line and the digital time.
+// Written digit by digit into fixed-size buffers, no strftime and no heap.
+
+#pragma once
+
+#include <stdbool.h>
+#include <time.h>
+
+// Capacities include the terminating NUL and fit the longest possible text
+#define TEXT_NUMERAL_SIZE sizeof("23")
+#define TEXT_DATE_SIZE sizeof("Wed, Sep 30")
+#define TEXT_TIME_SIZE sizeof("12:00 PM")
+
+// Hour numeral without a leading zero: "0" to "23", or "1" to "12"
+void formatNumeral(char numeral[TEXT_NUMERAL_SIZE], int hour, bool hourFormat);
+
+// "Mon, Jan  5", the day padded with a space like strftime's %e
+void formatDate(char date[TEXT_DATE_SIZE], const struct tm * time);
+
+// "09:05" in 24 hour format, " 9:05 AM" in 12 hour format
+void formatDigitalTime(char digitalTime[TEXT_TIME_SIZE], const struct tm * time, bool hourFormat);
@@ -0,0 +1,225 @@
+// 24 hours of ticks through tick_handler under the shim, one scenario per
+// line: what each tick cost in draw calls and in time. Counts are exact and
+// repeatable; the time columns are host time and only good for comparisons.
+// Each scenario is replayed a second time with every layer marked dirty on
+// every tick, which is what the face did before it tracked changes. Night
+// mode gets a day of its own, against the same day with it off, and each
+// render tier an hour.
+
+#include "macro_clock.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define readCycles() __rdtsc()
+#else
+#define readCycles() 0
+#endif
+
+#define BENCH_MINUTES (24 * 60)
+// 3:17, inside the default quiet hours
+#define NIGHT_TAP_MINUTE (3 * 60 + 17)
+
+static uint64_t nowNs() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+typedef struct {
+	const char *name;
+	void (*configure)(Settings *settings);
+	// Minute of the day a tap comes in, 0 for none
+	int tapMinute;
+} Scenario;
+
+static void alwaysOn(Settings *settings) {
+	settings->dateToggle = DT_ALWAYS_ON;
+	settings->digTimeToggle = DT_ALWAYS_ON;
+}
+
+static void smooth(Settings *settings) {
+	settings->smoothMotion = true;
+}
+
+static void nightMode(Settings *settings) {
+	settings->nightMode = true;
+}
+
+static const Scenario SCENARIOS[] = {
+	{ .name = "default" },
+	{ .name = "always_on", .configure = alwaysOn },
+	{ .name = "smooth", .configure = smooth }
+};
+
+static const Scenario NIGHT_SCENARIOS[] = {
+	{ .name = "night_off", .tapMinute = NIGHT_TAP_MINUTE },
+	{ .name = "night", .configure = nightMode, .tapMinute = NIGHT_TAP_MINUTE }
+};
+
+static double perTick(int count, int ticks) {
+	return ticks ? (double) count / ticks : 0;
+}
+
+typedef struct {
+	ShimStats stats;
+	uint64_t ns;
+	uint64_t cycles;
+} BenchResult;
+
+// What update_time did before it tracked changes: every layer, every tick
+static void markAllTick(struct tm *tick_time, TimeUnits units_changed) {
+	tick_handler(tick_time, units_changed);
+	layer_mark_dirty(s_dial_layer);
+	layer_mark_dirty(dateLayer);
+	layer_mark_dirty(dateLayer2);
+}
+
+// A day of the scenario, ticking through handler if one is given
+static BenchResult runScenario(const Scenario *scenario, TickHandler handler) {
+	startApp(HOST_START_TIME, scenario->configure);
+	if (handler) {
+		tick_timer_service_subscribe(s_tick_unit, handler);
+		shim_reset_stats();
+	}
+
+	BenchResult result;
+	uint64_t startNs = nowNs();
+	uint64_t startCycles = readCycles();
+	for (int minute = 0; minute < BENCH_MINUTES; minute++) {
+		if (scenario->tapMinute && minute == scenario->tapMinute) {
+			shim_tap();
+		}
+		runMinute();
+	}
+	result.cycles = readCycles() - startCycles;
+	result.ns = nowNs() - startNs;
+	result.stats = shim_stats;
+
+	stopApp();
+	return result;
+}
+
+static int drawCalls(const ShimStats *stats) {
+	return stats->fill_circle + stats->gpath_draw_filled + stats->gpath_draw_outline +
+		stats->draw_text + stats->draw_bitmap;
+}
+
+static void printCosts(const Scenario *scenario, const BenchResult *result) {
+	const ShimStats *stats = &result->stats;
+	int ticks = stats->ticks;
+	printf("%-10s %5d %6d %6d %7.2f %7.2f %7.2f %7.2f %7.2f %7.2f %9.0f %10.0f\n",
+		scenario->name, ticks, stats->frames, stats->layer_renders,
+		perTick(stats->fill_circle, ticks), perTick(stats->gpath_draw_filled, ticks),
+		perTick(stats->gpath_draw_outline, ticks), perTick(stats->draw_text, ticks),
+		perTick(stats->draw_bitmap, ticks), perTick(stats->layer_mark_dirty, ticks),
+		(double) result->ns / (ticks ? ticks : 1), (double) result->cycles / (ticks ? ticks : 1));
+}
+
+static double saved(double tracked, double all) {
+	return all ? 100 * (1 - tracked / all) : 0;
+}
+
+// Tracked against every-layer-every-tick, as totals over the day
+static void printSavings(const Scenario *scenario, const BenchResult *tracked, const BenchResult *all) {
+	const ShimStats *t = &tracked->stats;
+	const ShimStats *a = &all->stats;
+	int trackedLayers = t->layer_renders + t->text_layer_renders;
+	int allLayers = a->layer_renders + a->text_layer_renders;
+	printf("%-10s %6d/%-6d %4.0f%% %6d/%-6d %4.0f%% %6d/%-6d %4.0f%% %6d/%-6d %4.0f%% %4.0f%%\n",
+		scenario->name,
+		t->layer_mark_dirty, a->layer_mark_dirty, saved(t->layer_mark_dirty, a->layer_mark_dirty),
+		t->frames, a->frames, saved(t->frames, a->frames),
+		trackedLayers, allLayers, saved(trackedLayers, allLayers),
+		drawCalls(t), drawCalls(a), saved(drawCalls(t), drawCalls(a)),
+		saved(tracked->ns, all->ns));
+}
+
+typedef struct {
+	const char *name;
+	BatteryChargeState battery;
+} Tier;
+
+static const Tier TIERS[] = {
+	{ .name = "full", .battery = { .charge_percent = 100 } },
+	{ .name = "reduced", .battery = { .charge_percent = 25 } },
+	{ .name = "minimal", .battery = { .charge_percent = 5 } }
+};
+
+// The first frame at launch, which fills the dial cache, then an hour of ticks
+static void runTier(const Tier *tier) {
+	shim_reset();
+	storeSettings(alwaysOn);
+	shim_set_battery(tier->battery);
+	shim_set_time(HOST_START_TIME + 10 * 3600);
+	shim_reset_stats();
+	init();
+	shim_render_if_dirty();
+	ShimStats first = shim_stats;
+
+	shim_reset_stats();
+	for (int minute = 0; minute < 60; minute++) {
+		runMinute();
+	}
+	const ShimStats *hour = &shim_stats;
+	printf("%-10s %6d %6d %7d %6d %6d %6d %5d %6d %6d %7.2f\n", tier->name,
+		first.fill_circle, first.gpath_draw_filled, first.gpath_draw_outline, first.draw_text,
+		first.draw_bitmap, drawCalls(&first),
+		hour->ticks, hour->frames, drawCalls(hour), perTick(drawCalls(hour), hour->ticks));
+	stopApp();
+}
+
+// Every time the face is woken without a tap: ticks and its own timers
+static int wakeups(const ShimStats *stats) {
+	return stats->ticks + stats->timer_fires;
+}
+
+static void printNight(const Scenario *scenario, const BenchResult *result, const BenchResult *off) {
+	const ShimStats *stats = &result->stats;
+	printf("%-10s %7d %4.0f%% %6d %4.0f%% %6d %4.0f%%\n", scenario->name,
+		wakeups(stats), saved(wakeups(stats), wakeups(&off->stats)),
+		stats->frames, saved(stats->frames, off->stats.frames),
+		stats->layer_renders, saved(stats->layer_renders, off->stats.layer_renders));
+}
+
+int main(void) {
+	BenchResult tracked[ARRAY_LENGTH(SCENARIOS)];
+	BenchResult all[ARRAY_LENGTH(SCENARIOS)];
+	for (unsigned int i = 0; i < ARRAY_LENGTH(SCENARIOS); i++) {
+		tracked[i] = runScenario(&SCENARIOS[i], NULL);
+		all[i] = runScenario(&SCENARIOS[i], markAllTick);
+	}
+
+	printf("%d minutes from %ld, draw calls per tick\n", BENCH_MINUTES, (long) HOST_START_TIME);
+	printf("%-10s %5s %6s %6s %7s %7s %7s %7s %7s %7s %9s %10s\n",
+		"scenario", "ticks", "frames", "dial", "circle", "filled", "outline", "text", "blit", "dirty",
+		"ns/tick", "cyc/tick");
+	for (unsigned int i = 0; i < ARRAY_LENGTH(SCENARIOS); i++) {
+		printCosts(&SCENARIOS[i], &tracked[i]);
+	}
+
+	printf("\nredraw savings over the day, changed layers only / every layer every tick\n");
+	printf("%-10s %20s %20s %20s %20s %5s\n",
+		"scenario", "dirty marks", "frames", "layer draws", "draw calls", "time");
+	for (unsigned int i = 0; i < ARRAY_LENGTH(SCENARIOS); i++) {
+		printSavings(&SCENARIOS[i], &tracked[i], &all[i]);
+	}
+
+	BenchResult night[ARRAY_LENGTH(NIGHT_SCENARIOS)];
+	for (unsigned int i = 0; i < ARRAY_LENGTH(NIGHT_SCENARIOS); i++) {
+		night[i] = runScenario(&NIGHT_SCENARIOS[i], NULL);
+	}
+	printf("\nnight mode over the day, quiet from midnight to 8:00 with a tap at %d:%02d, saved against night_off\n",
+		NIGHT_TAP_MINUTE / 60, NIGHT_TAP_MINUTE % 60);
+	printf("%-10s %13s %13s %13s\n", "scenario", "wakeups", "frames", "dial");
+	for (unsigned int i = 0; i < ARRAY_LENGTH(NIGHT_SCENARIOS); i++) {
+		printNight(&NIGHT_SCENARIOS[i], &night[i], &night[0]);
+	}
+
+	printf("\ndraw calls per render tier, both date lines on: the first frame, then an hour from 10:00\n");
+	printf("%-10s %6s %6s %7s %6s %6s %6s %5s %6s %6s %7s\n", "tier",
+		"circle", "filled", "outline", "text", "blit", "frame", "ticks", "frames", "calls", "/tick");
+	for (unsigned int i = 0; i < ARRAY_LENGTH(TIERS); i++) {
+		runTier(&TIERS[i]);
+	}
+	return 0;
+}
@@ -0,0 +1,30 @@
+// Checks for the host tests: EXPECT records a failure and carries on, and
+// hostResult turns the tally into main's exit status.
+
+#pragma once
+
+#include <stdio.h>
+#include <time.h>
+
+// Monday 1 January 2024, 0:00
+#define HOST_START_TIME ((time_t) 1704067200)
+
+static int s_host_failures;
+
+#define EXPECT(cond, ...) do { \
+		if (!(cond)) { \
+			s_host_failures++; \
+			fprintf(stderr, "%s:%d: %s: ", __FILE__, __LINE__, #cond); \
+			fprintf(stderr, __VA_ARGS__); \
+			fputc('\n', stderr); \
+		} \
+	} while (0)
+
+static inline int hostResult(const char *name) {
+	if (s_host_failures) {
+		fprintf(stderr, "%s: %d failed\n", name, s_host_failures);
+		return 1;
+	}
+	printf("%s: ok\n", name);
+	return 0;
+}
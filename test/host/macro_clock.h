@@ -0,0 +1,61 @@
+// Pulls macroClockMain.c into a host program, statics and all, and starts
+// and stops it under the shim. Include from exactly one file per binary.
+
+#pragma once
+
+#define main macro_clock_main
+#include "macroClockMain.c"
+#undef main
+
+#include "host_test.h"
+#include "shim.h"
+
+// Stores the defaults changed by configure as the settings blob init reads
+static inline void storeSettings(void (*configure)(Settings *settings)) {
+	setDefaultSettings();
+	if (configure) {
+		configure(&s_settings);
+	}
+	StoredSettings stored;
+	packSettings(&stored, &s_settings);
+	shim_persist_set_raw(PK_SETTINGS, &stored, sizeof(stored));
+}
+
+// A fresh shim and a fresh start of the face at now, counters cleared
+static inline void startApp(time_t now, void (*configure)(Settings *settings)) {
+	shim_reset();
+	storeSettings(configure);
+	shim_set_time(now);
+	init();
+	shim_render_if_dirty();
+	shim_reset_stats();
+}
+
+// deinit, then back to the statics a newly started process would have
+static inline void stopApp() {
+	deinit();
+	s_tick_unit = 0;
+	s_night = false;
+	s_night_wake_until = 0;
+	s_tier = RT_FULL;
+	s_has_seq = false;
+	s_last_seq = 0;
+	s_smooth_frames = 0;
+	s_smooth_budget_hour = -1;
+	s_hand_angle = 0;
+	memset(&s_layout, 0, sizeof(s_layout));
+}
+
+// One minute of watch time: whatever runs during it, then the next tick
+static inline void runMinute() {
+	shim_advance_ms(60 * 1000);
+	shim_tick();
+}
+
+// An MK_CONFIG message of (MessageKeys, value) pairs, as the phone sends it
+static inline void sendConfig(const uint8_t *pairs, uint16_t length) {
+	DictionaryIterator iter;
+	shim_dict_init(&iter);
+	shim_dict_add_data(&iter, MK_CONFIG, pairs, length);
+	shim_deliver_message(&iter);
+}
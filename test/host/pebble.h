@@ -0,0 +1,391 @@
+// Host stand-in for the Pebble SDK 3 pebble.h, just the part the face uses.
+// The types and calls match the SDK; what they do lives in pebble_stub.c,
+// which draws into a software frame buffer and counts every call that
+// matters for performance. The platform comes from the same PBL_* defines
+// the SDK sets: PBL_BW for aplite, PBL_ROUND for chalk,
+// PBL_PLATFORM_EMERY for the large screen.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef PBL_BW
+#define PBL_IF_COLOR_ELSE(if_true, if_false) (if_false)
+#else
+#define PBL_COLOR
+#define PBL_IF_COLOR_ELSE(if_true, if_false) (if_true)
+#endif
+
+#ifdef PBL_ROUND
+#define PBL_IF_ROUND_ELSE(if_true, if_false) (if_true)
+#else
+#define PBL_RECT
+#define PBL_IF_ROUND_ELSE(if_true, if_false) (if_false)
+#endif
+
+#define ARRAY_LENGTH(array) (sizeof(array) / sizeof((array)[0]))
+
+// The clock is the harness clock, see shim_set_time
+time_t shim_time(time_t *tloc);
+struct tm *shim_localtime(const time_t *timep);
+#define time(tloc) shim_time(tloc)
+#define localtime(timep) shim_localtime(timep)
+
+uint16_t time_ms(time_t *tloc, uint16_t *out_ms);
+
+// Logging
+
+typedef enum {
+	APP_LOG_LEVEL_ERROR = 1,
+	APP_LOG_LEVEL_WARNING = 50,
+	APP_LOG_LEVEL_INFO = 100,
+	APP_LOG_LEVEL_DEBUG = 200,
+	APP_LOG_LEVEL_DEBUG_VERBOSE = 255
+} AppLogLevel;
+
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...)
+	__attribute__((format(printf, 4, 5)));
+#define APP_LOG(level, fmt, args...) app_log(level, __FILE__, __LINE__, fmt, ## args)
+
+// Geometry and color
+
+#define TRIG_MAX_ANGLE 0x10000
+#define TRIG_MAX_RATIO 0xffff
+
+int32_t sin_lookup(int32_t angle);
+int32_t cos_lookup(int32_t angle);
+
+typedef struct {
+	int16_t x;
+	int16_t y;
+} GPoint;
+#define GPoint(x, y) ((GPoint) { (x), (y) })
+
+typedef struct {
+	int16_t w;
+	int16_t h;
+} GSize;
+#define GSize(w, h) ((GSize) { (w), (h) })
+
+typedef struct {
+	GPoint origin;
+	GSize size;
+} GRect;
+#define GRect(x, y, w, h) ((GRect) { { (x), (y) }, { (w), (h) } })
+
+bool grect_equal(const GRect *rect_a, const GRect *rect_b);
+
+typedef union {
+	uint8_t argb;
+	struct {
+		uint8_t b:2;
+		uint8_t g:2;
+		uint8_t r:2;
+		uint8_t a:2;
+	};
+} GColor8;
+typedef GColor8 GColor;
+
+#define GColorClearARGB8 0x00
+#define GColorBlackARGB8 0xC0
+#define GColorWhiteARGB8 0xFF
+#define GColorRedARGB8 0xF0
+#define GColorOrangeARGB8 0xF8
+#define GColorYellowARGB8 0xFC
+#define GColorDarkGreenARGB8 0xC4
+#define GColorDukeBlueARGB8 0xC2
+#define GColorImperialPurpleARGB8 0xD1
+#define GColorShockingPinkARGB8 0xF7
+#define GColorDarkGrayARGB8 0xD5
+
+#define GColorClear ((GColor8) { .argb = GColorClearARGB8 })
+#define GColorBlack ((GColor8) { .argb = GColorBlackARGB8 })
+#define GColorWhite ((GColor8) { .argb = GColorWhiteARGB8 })
+
+bool gcolor_equal(GColor8 color_a, GColor8 color_b);
+
+// Bitmaps
+
+typedef enum {
+	GBitmapFormat1Bit = 0,
+	GBitmapFormat8Bit,
+	GBitmapFormat1BitPalette,
+	GBitmapFormat2BitPalette,
+	GBitmapFormat4BitPalette,
+	GBitmapFormat8BitCircular
+} GBitmapFormat;
+
+typedef struct GBitmap GBitmap;
+
+typedef struct {
+	uint8_t *data;
+	int16_t min_x;
+	int16_t max_x;
+} GBitmapDataRowInfo;
+
+GBitmap *gbitmap_create_blank(GSize size, GBitmapFormat format);
+void gbitmap_destroy(GBitmap *bitmap);
+uint8_t *gbitmap_get_data(const GBitmap *bitmap);
+uint16_t gbitmap_get_bytes_per_row(const GBitmap *bitmap);
+GRect gbitmap_get_bounds(const GBitmap *bitmap);
+GBitmapDataRowInfo gbitmap_get_data_row_info(const GBitmap *bitmap, uint16_t y);
+
+// Drawing
+
+typedef struct GContext GContext;
+typedef struct GFont *GFont;
+
+typedef enum {
+	GTextOverflowModeWordWrap,
+	GTextOverflowModeTrailingEllipsis,
+	GTextOverflowModeFill
+} GTextOverflowMode;
+
+typedef enum {
+	GTextAlignmentLeft,
+	GTextAlignmentCenter,
+	GTextAlignmentRight
+} GTextAlignment;
+
+typedef struct GTextAttributes GTextAttributes;
+
+#define FONT_KEY_BITHAM_42_BOLD "RESOURCE_ID_BITHAM_42_BOLD"
+#define FONT_KEY_ROBOTO_CONDENSED_21 "RESOURCE_ID_ROBOTO_CONDENSED_21"
+
+GFont fonts_get_system_font(const char *font_key);
+
+void graphics_context_set_stroke_color(GContext *ctx, GColor color);
+void graphics_context_set_fill_color(GContext *ctx, GColor color);
+void graphics_context_set_text_color(GContext *ctx, GColor color);
+void graphics_fill_circle(GContext *ctx, GPoint p, uint16_t radius);
+void graphics_draw_text(GContext *ctx, const char *text, const GFont font, const GRect box,
+	const GTextOverflowMode overflow_mode, const GTextAlignment alignment, GTextAttributes *text_attributes);
+void graphics_draw_bitmap_in_rect(GContext *ctx, const GBitmap *bitmap, GRect rect);
+GBitmap *graphics_capture_frame_buffer(GContext *ctx);
+bool graphics_release_frame_buffer(GContext *ctx, GBitmap *buffer);
+
+typedef struct {
+	uint32_t num_points;
+	GPoint *points;
+} GPathInfo;
+
+typedef struct GPath GPath;
+
+GPath *gpath_create(const GPathInfo *init);
+void gpath_destroy(GPath *path);
+void gpath_rotate_to(GPath *path, int32_t angle);
+void gpath_move_to(GPath *path, GPoint point);
+void gpath_draw_filled(GContext *ctx, GPath *path);
+void gpath_draw_outline(GContext *ctx, GPath *path);
+
+// Layers and windows
+
+typedef struct Layer Layer;
+typedef struct TextLayer TextLayer;
+typedef struct Window Window;
+
+typedef void (*LayerUpdateProc)(Layer *layer, GContext *ctx);
+
+Layer *layer_create(GRect frame);
+void layer_destroy(Layer *layer);
+void layer_mark_dirty(Layer *layer);
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc);
+void layer_add_child(Layer *parent, Layer *child);
+GRect layer_get_frame(const Layer *layer);
+GRect layer_get_bounds(const Layer *layer);
+void layer_set_hidden(Layer *layer, bool hidden);
+bool layer_get_hidden(const Layer *layer);
+
+TextLayer *text_layer_create(GRect frame);
+void text_layer_destroy(TextLayer *text_layer);
+Layer *text_layer_get_layer(TextLayer *text_layer);
+void text_layer_set_text(TextLayer *text_layer, const char *text);
+void text_layer_set_background_color(TextLayer *text_layer, GColor color);
+void text_layer_set_text_color(TextLayer *text_layer, GColor color);
+void text_layer_set_font(TextLayer *text_layer, GFont font);
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment text_alignment);
+
+typedef void (*WindowHandler)(Window *window);
+
+typedef struct {
+	WindowHandler load;
+	WindowHandler appear;
+	WindowHandler disappear;
+	WindowHandler unload;
+} WindowHandlers;
+
+Window *window_create(void);
+void window_destroy(Window *window);
+void window_set_window_handlers(Window *window, WindowHandlers handlers);
+void window_set_background_color(Window *window, GColor background_color);
+Layer *window_get_root_layer(const Window *window);
+void window_stack_push(Window *window, bool animated);
+Window *window_stack_pop(bool animated);
+
+// Animation
+
+typedef struct Animation Animation;
+typedef uint32_t AnimationProgress;
+#define ANIMATION_NORMALIZED_MAX 65535
+
+typedef enum {
+	AnimationCurveLinear,
+	AnimationCurveEaseIn,
+	AnimationCurveEaseOut,
+	AnimationCurveEaseInOut
+} AnimationCurve;
+
+typedef void (*AnimationSetupImplementation)(Animation *animation);
+typedef void (*AnimationUpdateImplementation)(Animation *animation, const AnimationProgress progress);
+typedef void (*AnimationTeardownImplementation)(Animation *animation);
+
+typedef struct {
+	AnimationSetupImplementation setup;
+	AnimationUpdateImplementation update;
+	AnimationTeardownImplementation teardown;
+} AnimationImplementation;
+
+typedef void (*AnimationStartedHandler)(Animation *animation, void *context);
+typedef void (*AnimationStoppedHandler)(Animation *animation, bool finished, void *context);
+
+typedef struct {
+	AnimationStartedHandler started;
+	AnimationStoppedHandler stopped;
+} AnimationHandlers;
+
+Animation *animation_create(void);
+bool animation_set_duration(Animation *animation, uint32_t duration_ms);
+bool animation_set_curve(Animation *animation, AnimationCurve curve);
+bool animation_set_implementation(Animation *animation, const AnimationImplementation *implementation);
+bool animation_set_handlers(Animation *animation, AnimationHandlers callbacks, void *context);
+bool animation_schedule(Animation *animation);
+bool animation_unschedule(Animation *animation);
+
+// Timers and services
+
+typedef struct AppTimer AppTimer;
+typedef void (*AppTimerCallback)(void *data);
+
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data);
+bool app_timer_reschedule(AppTimer *timer_handle, uint32_t new_timeout_ms);
+void app_timer_cancel(AppTimer *timer_handle);
+
+typedef enum {
+	SECOND_UNIT = 1 << 0,
+	MINUTE_UNIT = 1 << 1,
+	HOUR_UNIT = 1 << 2,
+	DAY_UNIT = 1 << 3,
+	MONTH_UNIT = 1 << 4,
+	YEAR_UNIT = 1 << 5
+} TimeUnits;
+
+typedef void (*TickHandler)(struct tm *tick_time, TimeUnits units_changed);
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler);
+void tick_timer_service_unsubscribe(void);
+
+typedef enum {
+	ACCEL_AXIS_X = 0,
+	ACCEL_AXIS_Y = 1,
+	ACCEL_AXIS_Z = 2
+} AccelAxisType;
+
+typedef void (*AccelTapHandler)(AccelAxisType axis, int32_t direction);
+void accel_tap_service_subscribe(AccelTapHandler handler);
+void accel_tap_service_unsubscribe(void);
+
+typedef void (*BluetoothConnectionHandler)(bool connected);
+void bluetooth_connection_service_subscribe(BluetoothConnectionHandler handler);
+void bluetooth_connection_service_unsubscribe(void);
+
+typedef struct {
+	uint8_t charge_percent;
+	bool is_charging;
+	bool is_plugged;
+} BatteryChargeState;
+
+typedef void (*BatteryStateHandler)(BatteryChargeState charge);
+BatteryChargeState battery_state_service_peek(void);
+void battery_state_service_subscribe(BatteryStateHandler handler);
+void battery_state_service_unsubscribe(void);
+
+typedef struct {
+	const uint32_t *durations;
+	uint32_t num_segments;
+} VibePattern;
+
+void vibes_long_pulse(void);
+void vibes_double_pulse(void);
+void vibes_enqueue_custom_pattern(VibePattern pattern);
+
+// Messages
+
+typedef enum {
+	TUPLE_BYTE_ARRAY = 0,
+	TUPLE_CSTRING = 1,
+	TUPLE_UINT = 2,
+	TUPLE_INT = 3
+} TupleType;
+
+// The SDK's own layout, zero-length arrays and all. Reading data[i] past
+// them is how every app reads a tuple, so GCC's bounds warning on those
+// arrays is off wherever this header is included.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 10
+#pragma GCC diagnostic ignored "-Wzero-length-bounds"
+#endif
+
+typedef struct __attribute__((__packed__)) {
+	uint32_t key;
+	TupleType type:8;
+	uint16_t length;
+	union {
+		uint8_t data[0];
+		char cstring[0];
+		uint8_t uint8;
+		uint16_t uint16;
+		uint32_t uint32;
+		int8_t int8;
+		int16_t int16;
+		int32_t int32;
+	} value[];
+} Tuple;
+
+typedef struct DictionaryIterator DictionaryIterator;
+Tuple *dict_find(const DictionaryIterator *iter, const uint32_t key);
+
+typedef enum {
+	APP_MSG_OK = 0,
+	APP_MSG_SEND_TIMEOUT = 1 << 1,
+	APP_MSG_BUSY = 1 << 10,
+	APP_MSG_BUFFER_OVERFLOW = 1 << 11
+} AppMessageResult;
+
+typedef void (*AppMessageInboxReceived)(DictionaryIterator *iterator, void *context);
+typedef void (*AppMessageInboxDropped)(AppMessageResult reason, void *context);
+
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound);
+void app_message_register_inbox_received(AppMessageInboxReceived received_callback);
+void app_message_register_inbox_dropped(AppMessageInboxDropped dropped_callback);
+void app_message_deregister_callbacks(void);
+
+// Storage
+
+bool persist_exists(const uint32_t key);
+int persist_get_size(const uint32_t key);
+bool persist_read_bool(const uint32_t key);
+int32_t persist_read_int(const uint32_t key);
+int persist_read_data(const uint32_t key, void *buffer, const size_t buffer_size);
+int persist_read_string(const uint32_t key, char *buffer, const size_t buffer_size);
+int persist_write_bool(const uint32_t key, const bool value);
+int persist_write_int(const uint32_t key, const int32_t value);
+int persist_write_data(const uint32_t key, const void *data, const size_t size);
+int persist_write_string(const uint32_t key, const char *cstring);
+int persist_delete(const uint32_t key);
+
+// App
+
+size_t heap_bytes_used(void);
+size_t heap_bytes_free(void);
+void app_event_loop(void);
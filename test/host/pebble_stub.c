@@ -0,0 +1,1367 @@
+// The shim's side of pebble.h. Everything the app calls either draws into
+// one software frame buffer, changes harness state or is counted in
+// shim_stats. Rendering works like the watch: any dirty mark redraws the
+// whole top window, layer tree in order, each layer clipped to its frame.
+
+#include "shim.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define E_DOES_NOT_EXIST (-4)
+#define PERSIST_DATA_MAX_LENGTH 256
+#define PERSIST_KEYS 32
+#define WINDOW_STACK_SIZE 4
+// Animations advance at the watch's frame rate
+#define ANIMATION_FRAME_MS 33
+
+const char *const SHIM_KIND_NAMES[SK_COUNT] = {
+	"window", "layer", "text_layer", "gbitmap", "gpath", "animation", "app_timer"
+};
+
+ShimStats shim_stats;
+
+struct GBitmap {
+	GBitmapFormat format;
+	GRect bounds;
+	uint16_t row_size;
+	bool round;
+	uint8_t *data;
+};
+
+struct GFont {
+	int height;
+};
+
+struct GContext {
+	GBitmap *frame_buffer;
+	GPoint offset;
+	GRect clip;
+	GColor stroke;
+	GColor fill;
+	GColor text;
+};
+
+struct GPath {
+	uint32_t num_points;
+	GPoint *points;
+	int32_t rotation;
+	GPoint offset;
+};
+
+struct Layer {
+	GRect frame;
+	bool hidden;
+	LayerUpdateProc update_proc;
+	Layer *parent;
+	Layer *first_child;
+	Layer *next_sibling;
+	TextLayer *text_layer;
+	int renders;
+};
+
+struct TextLayer {
+	Layer layer;
+	const char *text;
+	GColor background;
+	GColor color;
+	GFont font;
+	GTextAlignment alignment;
+};
+
+struct Window {
+	Layer root;
+	GColor background;
+	WindowHandlers handlers;
+	bool loaded;
+};
+
+struct Animation {
+	uint32_t duration;
+	const AnimationImplementation *implementation;
+	AnimationHandlers handlers;
+	void *context;
+	int64_t start_ms;
+	bool scheduled;
+	Animation *next;
+};
+
+struct AppTimer {
+	int64_t fire_ms;
+	AppTimerCallback callback;
+	void *data;
+	AppTimer *next;
+};
+
+typedef struct {
+	bool used;
+	uint32_t key;
+	int size;
+	uint8_t data[PERSIST_DATA_MAX_LENGTH];
+} PersistEntry;
+
+static int64_t s_now_ms;
+static struct tm s_local;
+
+static uint8_t s_frame_data[SHIM_SCREEN_H * SHIM_SCREEN_W];
+static GBitmap s_frame_buffer;
+static GContext s_ctx;
+static bool s_dirty;
+
+static struct GFont s_font_large = { 42 };
+static struct GFont s_font_small = { 21 };
+
+static Window *s_window_stack[WINDOW_STACK_SIZE];
+static int s_window_count;
+
+static Animation *s_animations;
+static AppTimer *s_timers;
+
+static TickHandler s_tick_handler;
+static TimeUnits s_tick_units;
+static struct tm s_last_tick;
+
+static AccelTapHandler s_tap_handler;
+static BluetoothConnectionHandler s_bt_handler;
+static BatteryStateHandler s_battery_handler;
+static BatteryChargeState s_battery = { .charge_percent = 100 };
+
+static AppMessageInboxReceived s_inbox_received;
+static AppMessageInboxDropped s_inbox_dropped;
+
+static int s_vibes;
+static uint32_t s_last_vibe_segments;
+
+static PersistEntry s_persist[PERSIST_KEYS];
+
+// Clock
+
+time_t shim_time(time_t *tloc) {
+	time_t now = (time_t) (s_now_ms / 1000);
+	if (tloc) {
+		*tloc = now;
+	}
+	return now;
+}
+
+struct tm *shim_localtime(const time_t *timep) {
+	gmtime_r(timep, &s_local);
+	return &s_local;
+}
+
+uint16_t time_ms(time_t *tloc, uint16_t *out_ms) {
+	uint16_t ms = (uint16_t) (s_now_ms % 1000);
+	shim_time(tloc);
+	if (out_ms) {
+		*out_ms = ms;
+	}
+	return ms;
+}
+
+void shim_set_time(time_t now) {
+	s_now_ms = (int64_t) now * 1000;
+}
+
+time_t shim_get_time(void) {
+	return (time_t) (s_now_ms / 1000);
+}
+
+void app_log(uint8_t log_level, const char *src_filename, int src_line_number, const char *fmt, ...) {
+	if (!getenv("SHIM_LOG")) {
+		return;
+	}
+	va_list args;
+	va_start(args, fmt);
+	fprintf(stderr, "[%d] %s:%d ", log_level, src_filename, src_line_number);
+	vfprintf(stderr, fmt, args);
+	fputc('\n', stderr);
+	va_end(args);
+}
+
+// Geometry and color
+
+int32_t sin_lookup(int32_t angle) {
+	return (int32_t) lround(sin(angle * 2.0 * M_PI / TRIG_MAX_ANGLE) * TRIG_MAX_RATIO);
+}
+
+int32_t cos_lookup(int32_t angle) {
+	return (int32_t) lround(cos(angle * 2.0 * M_PI / TRIG_MAX_ANGLE) * TRIG_MAX_RATIO);
+}
+
+bool grect_equal(const GRect *rect_a, const GRect *rect_b) {
+	return rect_a->origin.x == rect_b->origin.x && rect_a->origin.y == rect_b->origin.y &&
+		rect_a->size.w == rect_b->size.w && rect_a->size.h == rect_b->size.h;
+}
+
+bool gcolor_equal(GColor8 color_a, GColor8 color_b) {
+	return color_a.argb == color_b.argb;
+}
+
+static GRect intersect(GRect a, GRect b) {
+	int x0 = a.origin.x > b.origin.x ? a.origin.x : b.origin.x;
+	int y0 = a.origin.y > b.origin.y ? a.origin.y : b.origin.y;
+	int x1 = a.origin.x + a.size.w < b.origin.x + b.size.w ? a.origin.x + a.size.w : b.origin.x + b.size.w;
+	int y1 = a.origin.y + a.size.h < b.origin.y + b.size.h ? a.origin.y + a.size.h : b.origin.y + b.size.h;
+	return GRect(x0, y0, x1 > x0 ? x1 - x0 : 0, y1 > y0 ? y1 - y0 : 0);
+}
+
+// Bitmaps
+
+static uint16_t rowSize(GSize size, GBitmapFormat format) {
+	return format == GBitmapFormat1Bit ? ((size.w + 31) / 32) * 4 : size.w;
+}
+
+GBitmap *gbitmap_create_blank(GSize size, GBitmapFormat format) {
+	if (format != GBitmapFormat1Bit && format != GBitmapFormat8Bit) {
+		return NULL;
+	}
+	GBitmap *bitmap = calloc(1, sizeof(GBitmap));
+	bitmap->format = format;
+	bitmap->bounds = GRect(0, 0, size.w, size.h);
+	bitmap->row_size = rowSize(size, format);
+	bitmap->data = calloc(size.h, bitmap->row_size);
+	shim_stats.created[SK_GBITMAP]++;
+	return bitmap;
+}
+
+void gbitmap_destroy(GBitmap *bitmap) {
+	if (!bitmap) {
+		return;
+	}
+	free(bitmap->data);
+	free(bitmap);
+	shim_stats.destroyed[SK_GBITMAP]++;
+}
+
+uint8_t *gbitmap_get_data(const GBitmap *bitmap) {
+	return bitmap->data;
+}
+
+uint16_t gbitmap_get_bytes_per_row(const GBitmap *bitmap) {
+	return bitmap->row_size;
+}
+
+GRect gbitmap_get_bounds(const GBitmap *bitmap) {
+	return bitmap->bounds;
+}
+
+// Round displays only have the pixels inside the circle
+GBitmapDataRowInfo gbitmap_get_data_row_info(const GBitmap *bitmap, uint16_t y) {
+	GBitmapDataRowInfo info = { bitmap->data + y * bitmap->row_size, 0, bitmap->bounds.size.w - 1 };
+	if (bitmap->round) {
+		double radius = bitmap->bounds.size.w / 2.0;
+		double dy = y + 0.5 - bitmap->bounds.size.h / 2.0;
+		double half = dy * dy < radius * radius ? sqrt(radius * radius - dy * dy) : 0;
+		info.min_x = (int16_t) floor(radius - half);
+		info.max_x = (int16_t) ceil(radius + half) - 1;
+	}
+	return info;
+}
+
+static bool isVisible(const GBitmap *bitmap, int x, int y) {
+	if (x < 0 || y < 0 || x >= bitmap->bounds.size.w || y >= bitmap->bounds.size.h) {
+		return false;
+	}
+	if (bitmap->round) {
+		GBitmapDataRowInfo info = gbitmap_get_data_row_info(bitmap, y);
+		return x >= info.min_x && x <= info.max_x;
+	}
+	return true;
+}
+
+// 1-bit pixels are white for white and black for anything else
+static uint8_t getPixel(const GBitmap *bitmap, int x, int y) {
+	if (!isVisible(bitmap, x, y)) {
+		return GColorClearARGB8;
+	}
+	if (bitmap->format == GBitmapFormat1Bit) {
+		bool white = (bitmap->data[y * bitmap->row_size + x / 8] >> (x % 8)) & 1;
+		return white ? GColorWhiteARGB8 : GColorBlackARGB8;
+	}
+	return bitmap->data[y * bitmap->row_size + x];
+}
+
+// Transparent colors leave the pixel alone
+static void setPixel(GBitmap *bitmap, int x, int y, uint8_t argb) {
+	if ((argb >> 6) == 0 || !isVisible(bitmap, x, y)) {
+		return;
+	}
+	if (bitmap->format == GBitmapFormat1Bit) {
+		uint8_t *byte = &bitmap->data[y * bitmap->row_size + x / 8];
+		if (argb == GColorWhiteARGB8) {
+			*byte |= 1 << (x % 8);
+		}
+		else {
+			*byte &= ~(1 << (x % 8));
+		}
+	}
+	else {
+		bitmap->data[y * bitmap->row_size + x] = argb;
+	}
+}
+
+GBitmap *shim_frame_buffer(void) {
+	if (!s_frame_buffer.data) {
+		s_frame_buffer.format = PBL_IF_COLOR_ELSE(GBitmapFormat8Bit, GBitmapFormat1Bit);
+		s_frame_buffer.bounds = GRect(0, 0, SHIM_SCREEN_W, SHIM_SCREEN_H);
+		s_frame_buffer.row_size = rowSize(s_frame_buffer.bounds.size, s_frame_buffer.format);
+		s_frame_buffer.round = PBL_IF_ROUND_ELSE(true, false);
+		s_frame_buffer.data = s_frame_data;
+	}
+	return &s_frame_buffer;
+}
+
+uint8_t shim_get_pixel(int x, int y) {
+	return getPixel(shim_frame_buffer(), x, y);
+}
+
+// Drawing, in the coordinates of the layer being drawn
+
+static void plot(GContext *ctx, int x, int y, GColor color) {
+	x += ctx->offset.x;
+	y += ctx->offset.y;
+	if (x < ctx->clip.origin.x || y < ctx->clip.origin.y ||
+		x >= ctx->clip.origin.x + ctx->clip.size.w || y >= ctx->clip.origin.y + ctx->clip.size.h) {
+		return;
+	}
+	setPixel(ctx->frame_buffer, x, y, color.argb);
+}
+
+static void fillRect(GContext *ctx, GRect rect, GColor color) {
+	for (int y = rect.origin.y; y < rect.origin.y + rect.size.h; y++) {
+		for (int x = rect.origin.x; x < rect.origin.x + rect.size.w; x++) {
+			plot(ctx, x, y, color);
+		}
+	}
+}
+
+static void drawLine(GContext *ctx, GPoint p0, GPoint p1, GColor color) {
+	int dx = abs(p1.x - p0.x);
+	int dy = -abs(p1.y - p0.y);
+	int sx = p0.x < p1.x ? 1 : -1;
+	int sy = p0.y < p1.y ? 1 : -1;
+	int err = dx + dy;
+	int x = p0.x;
+	int y = p0.y;
+	for (;;) {
+		plot(ctx, x, y, color);
+		if (x == p1.x && y == p1.y) {
+			break;
+		}
+		int e2 = 2 * err;
+		if (e2 >= dy) {
+			err += dy;
+			x += sx;
+		}
+		if (e2 <= dx) {
+			err += dx;
+			y += sy;
+		}
+	}
+}
+
+// No font data here: each character is a fixed pattern in a cell half as
+// wide as the font is high, which is enough to tell texts and places apart
+static void drawText(GContext *ctx, const char *text, const GFont font, GRect box, GTextAlignment alignment, GColor color) {
+	if (!text || !font) {
+		return;
+	}
+	int height = font->height;
+	int width = height / 2;
+	int advance = width + 2;
+	int length = (int) strlen(text);
+	int textWidth = length ? length * advance - 2 : 0;
+	int x0 = box.origin.x;
+	if (alignment == GTextAlignmentCenter) {
+		x0 += (box.size.w - textWidth) / 2;
+	}
+	else if (alignment == GTextAlignmentRight) {
+		x0 += box.size.w - textWidth;
+	}
+	for (int i = 0; i < length; i++) {
+		unsigned char c = text[i];
+		if (c == ' ') {
+			continue;
+		}
+		for (int gy = 0; gy < height && gy < box.size.h; gy++) {
+			for (int gx = 0; gx < width; gx++) {
+				if ((c * 37 + gx * 11 + gy * 7) % 5 < 2) {
+					plot(ctx, x0 + i * advance + gx, box.origin.y + gy, color);
+				}
+			}
+		}
+	}
+}
+
+GFont fonts_get_system_font(const char *font_key) {
+	return strcmp(font_key, FONT_KEY_BITHAM_42_BOLD) == 0 ? &s_font_large : &s_font_small;
+}
+
+void graphics_context_set_stroke_color(GContext *ctx, GColor color) {
+	ctx->stroke = color;
+}
+
+void graphics_context_set_fill_color(GContext *ctx, GColor color) {
+	ctx->fill = color;
+}
+
+void graphics_context_set_text_color(GContext *ctx, GColor color) {
+	ctx->text = color;
+}
+
+void graphics_fill_circle(GContext *ctx, GPoint p, uint16_t radius) {
+	shim_stats.fill_circle++;
+	int r = radius;
+	for (int dy = -r; dy <= r; dy++) {
+		for (int dx = -r; dx <= r; dx++) {
+			if (dx * dx + dy * dy <= r * r + r) {
+				plot(ctx, p.x + dx, p.y + dy, ctx->fill);
+			}
+		}
+	}
+}
+
+void graphics_draw_text(GContext *ctx, const char *text, const GFont font, const GRect box,
+	const GTextOverflowMode overflow_mode, const GTextAlignment alignment, GTextAttributes *text_attributes) {
+	shim_stats.draw_text++;
+	drawText(ctx, text, font, box, alignment, ctx->text);
+}
+
+void graphics_draw_bitmap_in_rect(GContext *ctx, const GBitmap *bitmap, GRect rect) {
+	shim_stats.draw_bitmap++;
+	for (int y = 0; y < rect.size.h && y < bitmap->bounds.size.h; y++) {
+		for (int x = 0; x < rect.size.w && x < bitmap->bounds.size.w; x++) {
+			plot(ctx, rect.origin.x + x, rect.origin.y + y, (GColor) { .argb = getPixel(bitmap, x, y) });
+		}
+	}
+}
+
+GBitmap *graphics_capture_frame_buffer(GContext *ctx) {
+	shim_stats.capture_frame_buffer++;
+	return ctx->frame_buffer;
+}
+
+bool graphics_release_frame_buffer(GContext *ctx, GBitmap *buffer) {
+	return buffer == ctx->frame_buffer;
+}
+
+// Paths
+
+GPath *gpath_create(const GPathInfo *init) {
+	GPath *path = calloc(1, sizeof(GPath));
+	path->num_points = init->num_points;
+	path->points = init->points;
+	shim_stats.created[SK_GPATH]++;
+	return path;
+}
+
+void gpath_destroy(GPath *path) {
+	if (!path) {
+		return;
+	}
+	free(path);
+	shim_stats.destroyed[SK_GPATH]++;
+}
+
+void gpath_rotate_to(GPath *path, int32_t angle) {
+	path->rotation = angle;
+}
+
+void gpath_move_to(GPath *path, GPoint point) {
+	path->offset = point;
+}
+
+static GPoint transformPoint(const GPath *path, GPoint point) {
+	int32_t cosine = cos_lookup(path->rotation);
+	int32_t sine = sin_lookup(path->rotation);
+	return GPoint((int16_t) ((point.x * cosine - point.y * sine) / TRIG_MAX_RATIO + path->offset.x),
+		(int16_t) ((point.x * sine + point.y * cosine) / TRIG_MAX_RATIO + path->offset.y));
+}
+
+// Scanline fill sampled at whole pixel rows
+void gpath_draw_filled(GContext *ctx, GPath *path) {
+	shim_stats.gpath_draw_filled++;
+	if (path->num_points < 3) {
+		return;
+	}
+	GPoint points[path->num_points];
+	int minY = INT16_MAX;
+	int maxY = INT16_MIN;
+	for (uint32_t i = 0; i < path->num_points; i++) {
+		points[i] = transformPoint(path, path->points[i]);
+		minY = points[i].y < minY ? points[i].y : minY;
+		maxY = points[i].y > maxY ? points[i].y : maxY;
+	}
+	for (int y = minY; y <= maxY; y++) {
+		double crossings[path->num_points];
+		int count = 0;
+		for (uint32_t i = 0; i < path->num_points; i++) {
+			GPoint a = points[i];
+			GPoint b = points[(i + 1) % path->num_points];
+			if ((a.y <= y && y < b.y) || (b.y <= y && y < a.y)) {
+				crossings[count++] = a.x + (double) (y - a.y) * (b.x - a.x) / (b.y - a.y);
+			}
+		}
+		for (int i = 1; i < count; i++) {
+			for (int j = i; j > 0 && crossings[j - 1] > crossings[j]; j--) {
+				double swap = crossings[j];
+				crossings[j] = crossings[j - 1];
+				crossings[j - 1] = swap;
+			}
+		}
+		for (int i = 0; i + 1 < count; i += 2) {
+			for (int x = (int) ceil(crossings[i]); x <= (int) floor(crossings[i + 1]); x++) {
+				plot(ctx, x, y, ctx->fill);
+			}
+		}
+	}
+}
+
+void gpath_draw_outline(GContext *ctx, GPath *path) {
+	shim_stats.gpath_draw_outline++;
+	uint32_t edges = path->num_points > 2 ? path->num_points : path->num_points - 1;
+	for (uint32_t i = 0; path->num_points > 1 && i < edges; i++) {
+		drawLine(ctx, transformPoint(path, path->points[i]),
+			transformPoint(path, path->points[(i + 1) % path->num_points]), ctx->stroke);
+	}
+}
+
+// Layers
+
+static void detachLayer(Layer *layer) {
+	if (!layer->parent) {
+		return;
+	}
+	Layer **link = &layer->parent->first_child;
+	while (*link && *link != layer) {
+		link = &(*link)->next_sibling;
+	}
+	if (*link) {
+		*link = layer->next_sibling;
+	}
+	layer->parent = NULL;
+	layer->next_sibling = NULL;
+	s_dirty = true;
+}
+
+static void orphanChildren(Layer *layer) {
+	Layer *child = layer->first_child;
+	while (child) {
+		Layer *next = child->next_sibling;
+		child->parent = NULL;
+		child->next_sibling = NULL;
+		child = next;
+	}
+	layer->first_child = NULL;
+}
+
+static void initLayer(Layer *layer, GRect frame) {
+	memset(layer, 0, sizeof(*layer));
+	layer->frame = frame;
+}
+
+Layer *layer_create(GRect frame) {
+	Layer *layer = malloc(sizeof(Layer));
+	initLayer(layer, frame);
+	shim_stats.created[SK_LAYER]++;
+	return layer;
+}
+
+void layer_destroy(Layer *layer) {
+	if (!layer) {
+		return;
+	}
+	detachLayer(layer);
+	orphanChildren(layer);
+	free(layer);
+	shim_stats.destroyed[SK_LAYER]++;
+}
+
+void layer_mark_dirty(Layer *layer) {
+	shim_stats.layer_mark_dirty++;
+	s_dirty = true;
+}
+
+void layer_set_update_proc(Layer *layer, LayerUpdateProc update_proc) {
+	layer->update_proc = update_proc;
+}
+
+void layer_add_child(Layer *parent, Layer *child) {
+	detachLayer(child);
+	Layer **link = &parent->first_child;
+	while (*link) {
+		link = &(*link)->next_sibling;
+	}
+	*link = child;
+	child->parent = parent;
+	s_dirty = true;
+}
+
+GRect layer_get_frame(const Layer *layer) {
+	return layer->frame;
+}
+
+GRect layer_get_bounds(const Layer *layer) {
+	return GRect(0, 0, layer->frame.size.w, layer->frame.size.h);
+}
+
+void layer_set_hidden(Layer *layer, bool hidden) {
+	if (layer->hidden != hidden) {
+		layer->hidden = hidden;
+		s_dirty = true;
+	}
+}
+
+bool layer_get_hidden(const Layer *layer) {
+	return layer->hidden;
+}
+
+int shim_layer_renders(const Layer *layer) {
+	return layer->renders;
+}
+
+TextLayer *text_layer_create(GRect frame) {
+	TextLayer *text_layer = calloc(1, sizeof(TextLayer));
+	initLayer(&text_layer->layer, frame);
+	text_layer->layer.text_layer = text_layer;
+	text_layer->background = GColorWhite;
+	text_layer->color = GColorBlack;
+	text_layer->font = &s_font_small;
+	text_layer->alignment = GTextAlignmentLeft;
+	shim_stats.created[SK_TEXT_LAYER]++;
+	return text_layer;
+}
+
+void text_layer_destroy(TextLayer *text_layer) {
+	if (!text_layer) {
+		return;
+	}
+	detachLayer(&text_layer->layer);
+	orphanChildren(&text_layer->layer);
+	free(text_layer);
+	shim_stats.destroyed[SK_TEXT_LAYER]++;
+}
+
+Layer *text_layer_get_layer(TextLayer *text_layer) {
+	return &text_layer->layer;
+}
+
+// Like the SDK, every text layer setter redraws
+void text_layer_set_text(TextLayer *text_layer, const char *text) {
+	text_layer->text = text;
+	s_dirty = true;
+}
+
+void text_layer_set_background_color(TextLayer *text_layer, GColor color) {
+	text_layer->background = color;
+	s_dirty = true;
+}
+
+void text_layer_set_text_color(TextLayer *text_layer, GColor color) {
+	text_layer->color = color;
+	s_dirty = true;
+}
+
+void text_layer_set_font(TextLayer *text_layer, GFont font) {
+	text_layer->font = font;
+	s_dirty = true;
+}
+
+void text_layer_set_text_alignment(TextLayer *text_layer, GTextAlignment text_alignment) {
+	text_layer->alignment = text_alignment;
+	s_dirty = true;
+}
+
+// Windows
+
+Window *window_create(void) {
+	Window *window = calloc(1, sizeof(Window));
+	initLayer(&window->root, GRect(0, 0, SHIM_SCREEN_W, SHIM_SCREEN_H));
+	window->background = GColorWhite;
+	shim_stats.created[SK_WINDOW]++;
+	return window;
+}
+
+static void unloadWindow(Window *window) {
+	if (window->loaded) {
+		window->loaded = false;
+		if (window->handlers.unload) {
+			window->handlers.unload(window);
+		}
+	}
+}
+
+void window_destroy(Window *window) {
+	if (!window) {
+		return;
+	}
+	for (int i = 0; i < s_window_count; i++) {
+		if (s_window_stack[i] == window) {
+			memmove(&s_window_stack[i], &s_window_stack[i + 1], (s_window_count - i - 1) * sizeof(Window *));
+			s_window_count--;
+			break;
+		}
+	}
+	unloadWindow(window);
+	orphanChildren(&window->root);
+	free(window);
+	shim_stats.destroyed[SK_WINDOW]++;
+}
+
+void window_set_window_handlers(Window *window, WindowHandlers handlers) {
+	window->handlers = handlers;
+}
+
+void window_set_background_color(Window *window, GColor background_color) {
+	window->background = background_color;
+	s_dirty = true;
+}
+
+Layer *window_get_root_layer(const Window *window) {
+	return (Layer *) &window->root;
+}
+
+void window_stack_push(Window *window, bool animated) {
+	if (s_window_count == WINDOW_STACK_SIZE) {
+		return;
+	}
+	s_window_stack[s_window_count++] = window;
+	if (!window->loaded) {
+		window->loaded = true;
+		if (window->handlers.load) {
+			window->handlers.load(window);
+		}
+	}
+	s_dirty = true;
+}
+
+Window *window_stack_pop(bool animated) {
+	if (s_window_count == 0) {
+		return NULL;
+	}
+	Window *window = s_window_stack[--s_window_count];
+	unloadWindow(window);
+	s_dirty = true;
+	return window;
+}
+
+// Rendering
+
+static void renderLayer(Layer *layer, GPoint origin, GRect clip) {
+	if (layer->hidden) {
+		return;
+	}
+	origin.x += layer->frame.origin.x;
+	origin.y += layer->frame.origin.y;
+	clip = intersect(clip, (GRect) { origin, layer->frame.size });
+
+	// Each layer starts from a fresh context, as on the watch
+	s_ctx.offset = origin;
+	s_ctx.clip = clip;
+	s_ctx.stroke = GColorBlack;
+	s_ctx.fill = GColorBlack;
+	s_ctx.text = GColorBlack;
+
+	TextLayer *text_layer = layer->text_layer;
+	if (text_layer) {
+		shim_stats.text_layer_renders++;
+		fillRect(&s_ctx, layer_get_bounds(layer), text_layer->background);
+		drawText(&s_ctx, text_layer->text, text_layer->font, layer_get_bounds(layer),
+			text_layer->alignment, text_layer->color);
+	}
+	else if (layer->update_proc) {
+		shim_stats.layer_renders++;
+		layer->renders++;
+		layer->update_proc(layer, &s_ctx);
+	}
+
+	for (Layer *child = layer->first_child; child; child = child->next_sibling) {
+		renderLayer(child, origin, clip);
+	}
+}
+
+void shim_render(void) {
+	s_dirty = false;
+	if (s_window_count == 0) {
+		return;
+	}
+	Window *window = s_window_stack[s_window_count - 1];
+	s_ctx.frame_buffer = shim_frame_buffer();
+	GRect screen = GRect(0, 0, SHIM_SCREEN_W, SHIM_SCREEN_H);
+	s_ctx.offset = GPoint(0, 0);
+	s_ctx.clip = screen;
+	fillRect(&s_ctx, screen, window->background);
+	renderLayer(&window->root, GPoint(0, 0), screen);
+	shim_stats.frames++;
+}
+
+bool shim_render_if_dirty(void) {
+	if (!s_dirty) {
+		return false;
+	}
+	shim_render();
+	return true;
+}
+
+// Animations
+
+Animation *animation_create(void) {
+	Animation *animation = calloc(1, sizeof(Animation));
+	animation->duration = 250;
+	shim_stats.created[SK_ANIMATION]++;
+	return animation;
+}
+
+bool animation_set_duration(Animation *animation, uint32_t duration_ms) {
+	animation->duration = duration_ms;
+	return true;
+}
+
+bool animation_set_curve(Animation *animation, AnimationCurve curve) {
+	return true;
+}
+
+bool animation_set_implementation(Animation *animation, const AnimationImplementation *implementation) {
+	animation->implementation = implementation;
+	return true;
+}
+
+bool animation_set_handlers(Animation *animation, AnimationHandlers callbacks, void *context) {
+	animation->handlers = callbacks;
+	animation->context = context;
+	return true;
+}
+
+bool animation_schedule(Animation *animation) {
+	if (animation->scheduled) {
+		return false;
+	}
+	animation->scheduled = true;
+	animation->start_ms = s_now_ms;
+	animation->next = s_animations;
+	s_animations = animation;
+	if (animation->handlers.started) {
+		animation->handlers.started(animation, animation->context);
+	}
+	return true;
+}
+
+// A stopped animation is destroyed by the system, as in SDK 3
+static void stopAnimation(Animation *animation, bool finished) {
+	Animation **link = &s_animations;
+	while (*link && *link != animation) {
+		link = &(*link)->next;
+	}
+	if (*link) {
+		*link = animation->next;
+	}
+	animation->scheduled = false;
+	if (animation->handlers.stopped) {
+		animation->handlers.stopped(animation, finished, animation->context);
+	}
+	free(animation);
+	shim_stats.destroyed[SK_ANIMATION]++;
+}
+
+bool animation_unschedule(Animation *animation) {
+	for (Animation *scheduled = s_animations; scheduled; scheduled = scheduled->next) {
+		if (scheduled == animation) {
+			stopAnimation(animation, false);
+			return true;
+		}
+	}
+	return false;
+}
+
+static void runAnimations(void) {
+	Animation *animation = s_animations;
+	while (animation) {
+		Animation *next = animation->next;
+		int64_t elapsed = s_now_ms - animation->start_ms;
+		bool done = elapsed >= animation->duration;
+		AnimationProgress progress = done ? ANIMATION_NORMALIZED_MAX :
+			(AnimationProgress) (elapsed * ANIMATION_NORMALIZED_MAX / animation->duration);
+		if (animation->implementation && animation->implementation->update) {
+			animation->implementation->update(animation, progress);
+		}
+		if (done) {
+			stopAnimation(animation, true);
+		}
+		animation = next;
+	}
+}
+
+// Timers
+
+AppTimer *app_timer_register(uint32_t timeout_ms, AppTimerCallback callback, void *callback_data) {
+	AppTimer *timer = calloc(1, sizeof(AppTimer));
+	timer->fire_ms = s_now_ms + timeout_ms;
+	timer->callback = callback;
+	timer->data = callback_data;
+	timer->next = s_timers;
+	s_timers = timer;
+	shim_stats.timer_registers++;
+	shim_stats.created[SK_APP_TIMER]++;
+	return timer;
+}
+
+static bool unlinkTimer(AppTimer *timer) {
+	AppTimer **link = &s_timers;
+	while (*link && *link != timer) {
+		link = &(*link)->next;
+	}
+	if (!*link) {
+		return false;
+	}
+	*link = timer->next;
+	return true;
+}
+
+static bool isPendingTimer(const AppTimer *timer) {
+	for (AppTimer *pending = s_timers; pending; pending = pending->next) {
+		if (pending == timer) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool app_timer_reschedule(AppTimer *timer_handle, uint32_t new_timeout_ms) {
+	shim_stats.timer_reschedules++;
+	if (!isPendingTimer(timer_handle)) {
+		return false;
+	}
+	timer_handle->fire_ms = s_now_ms + new_timeout_ms;
+	return true;
+}
+
+void app_timer_cancel(AppTimer *timer_handle) {
+	if (timer_handle && unlinkTimer(timer_handle)) {
+		shim_stats.timer_cancels++;
+		free(timer_handle);
+		shim_stats.destroyed[SK_APP_TIMER]++;
+	}
+}
+
+int shim_pending_timers(void) {
+	int count = 0;
+	for (AppTimer *timer = s_timers; timer; timer = timer->next) {
+		count++;
+	}
+	return count;
+}
+
+static int64_t nextTimerMs(void) {
+	int64_t next = INT64_MAX;
+	for (AppTimer *timer = s_timers; timer; timer = timer->next) {
+		next = timer->fire_ms < next ? timer->fire_ms : next;
+	}
+	return next;
+}
+
+static void fireDueTimers(void) {
+	bool fired;
+	do {
+		fired = false;
+		for (AppTimer *timer = s_timers; timer; timer = timer->next) {
+			if (timer->fire_ms <= s_now_ms) {
+				AppTimerCallback callback = timer->callback;
+				void *data = timer->data;
+				unlinkTimer(timer);
+				free(timer);
+				shim_stats.destroyed[SK_APP_TIMER]++;
+				shim_stats.timer_fires++;
+				callback(data);
+				fired = true;
+				break;
+			}
+		}
+	} while (fired);
+}
+
+void shim_advance_ms(uint32_t ms) {
+	int64_t end = s_now_ms + ms;
+	while (s_now_ms < end) {
+		int64_t next = nextTimerMs();
+		if (s_animations && s_now_ms + ANIMATION_FRAME_MS < next) {
+			next = s_now_ms + ANIMATION_FRAME_MS;
+		}
+		s_now_ms = next < end ? next : end;
+		fireDueTimers();
+		runAnimations();
+		shim_render_if_dirty();
+	}
+}
+
+// Services
+
+void tick_timer_service_subscribe(TimeUnits tick_units, TickHandler handler) {
+	shim_stats.tick_subscribes++;
+	s_tick_units = tick_units;
+	s_tick_handler = handler;
+	time_t now = shim_get_time();
+	gmtime_r(&now, &s_last_tick);
+}
+
+void tick_timer_service_unsubscribe(void) {
+	s_tick_handler = NULL;
+	s_tick_units = 0;
+}
+
+static TimeUnits changedUnits(const struct tm *from, const struct tm *to) {
+	TimeUnits changed = 0;
+	if (from->tm_sec != to->tm_sec) {
+		changed |= SECOND_UNIT;
+	}
+	if (from->tm_min != to->tm_min) {
+		changed |= MINUTE_UNIT;
+	}
+	if (from->tm_hour != to->tm_hour) {
+		changed |= HOUR_UNIT;
+	}
+	if (from->tm_mday != to->tm_mday) {
+		changed |= DAY_UNIT;
+	}
+	if (from->tm_mon != to->tm_mon) {
+		changed |= MONTH_UNIT;
+	}
+	if (from->tm_year != to->tm_year) {
+		changed |= YEAR_UNIT;
+	}
+	return changed;
+}
+
+bool shim_tick(void) {
+	time_t now = shim_get_time();
+	struct tm tick_time;
+	gmtime_r(&now, &tick_time);
+	TimeUnits changed = changedUnits(&s_last_tick, &tick_time);
+	s_last_tick = tick_time;
+	if (!s_tick_handler || !(changed & s_tick_units)) {
+		return false;
+	}
+	shim_stats.ticks++;
+	s_tick_handler(&tick_time, changed);
+	shim_render_if_dirty();
+	return true;
+}
+
+void accel_tap_service_subscribe(AccelTapHandler handler) {
+	s_tap_handler = handler;
+}
+
+void accel_tap_service_unsubscribe(void) {
+	s_tap_handler = NULL;
+}
+
+void shim_tap(void) {
+	if (s_tap_handler) {
+		s_tap_handler(ACCEL_AXIS_Z, 1);
+		shim_render_if_dirty();
+	}
+}
+
+void bluetooth_connection_service_subscribe(BluetoothConnectionHandler handler) {
+	s_bt_handler = handler;
+}
+
+void bluetooth_connection_service_unsubscribe(void) {
+	s_bt_handler = NULL;
+}
+
+void shim_set_bluetooth(bool connected) {
+	if (s_bt_handler) {
+		s_bt_handler(connected);
+		shim_render_if_dirty();
+	}
+}
+
+BatteryChargeState battery_state_service_peek(void) {
+	return s_battery;
+}
+
+void battery_state_service_subscribe(BatteryStateHandler handler) {
+	s_battery_handler = handler;
+}
+
+void battery_state_service_unsubscribe(void) {
+	s_battery_handler = NULL;
+}
+
+void shim_set_battery(BatteryChargeState state) {
+	s_battery = state;
+	if (s_battery_handler) {
+		s_battery_handler(state);
+		shim_render_if_dirty();
+	}
+}
+
+void vibes_long_pulse(void) {
+	shim_stats.vibes++;
+	s_vibes++;
+	s_last_vibe_segments = 1;
+}
+
+void vibes_double_pulse(void) {
+	shim_stats.vibes++;
+	s_vibes++;
+	s_last_vibe_segments = 3;
+}
+
+void vibes_enqueue_custom_pattern(VibePattern pattern) {
+	shim_stats.vibes++;
+	s_vibes++;
+	s_last_vibe_segments = pattern.num_segments;
+}
+
+int shim_vibe_count(void) {
+	return s_vibes;
+}
+
+uint32_t shim_last_vibe_segments(void) {
+	return s_last_vibe_segments;
+}
+
+// Messages
+
+AppMessageResult app_message_open(const uint32_t size_inbound, const uint32_t size_outbound) {
+	return APP_MSG_OK;
+}
+
+void app_message_register_inbox_received(AppMessageInboxReceived received_callback) {
+	s_inbox_received = received_callback;
+}
+
+void app_message_register_inbox_dropped(AppMessageInboxDropped dropped_callback) {
+	s_inbox_dropped = dropped_callback;
+}
+
+void app_message_deregister_callbacks(void) {
+	s_inbox_received = NULL;
+	s_inbox_dropped = NULL;
+}
+
+void shim_dict_init(DictionaryIterator *iter) {
+	iter->used = 0;
+}
+
+void shim_dict_add_data(DictionaryIterator *iter, uint32_t key, const uint8_t *data, uint16_t length) {
+	if (iter->used + (int) sizeof(Tuple) + length > SHIM_DICT_BYTES) {
+		return;
+	}
+	Tuple *tuple = (Tuple *) (iter->buffer + iter->used);
+	tuple->key = key;
+	tuple->type = TUPLE_BYTE_ARRAY;
+	tuple->length = length;
+	memcpy(tuple->value->data, data, length);
+	iter->used += sizeof(Tuple) + length;
+}
+
+void shim_dict_add_int32(DictionaryIterator *iter, uint32_t key, int32_t value) {
+	if (iter->used + (int) sizeof(Tuple) + 4 > SHIM_DICT_BYTES) {
+		return;
+	}
+	Tuple *tuple = (Tuple *) (iter->buffer + iter->used);
+	tuple->key = key;
+	tuple->type = TUPLE_INT;
+	tuple->length = 4;
+	memcpy(tuple->value->data, &value, 4);
+	iter->used += sizeof(Tuple) + 4;
+}
+
+Tuple *dict_find(const DictionaryIterator *iter, const uint32_t key) {
+	int offset = 0;
+	while (offset < iter->used) {
+		Tuple *tuple = (Tuple *) (iter->buffer + offset);
+		if (tuple->key == key) {
+			return tuple;
+		}
+		offset += sizeof(Tuple) + tuple->length;
+	}
+	return NULL;
+}
+
+void shim_deliver_message(DictionaryIterator *iter) {
+	if (s_inbox_received) {
+		s_inbox_received(iter, NULL);
+		shim_render_if_dirty();
+	}
+}
+
+// Storage
+
+static PersistEntry *findEntry(uint32_t key) {
+	for (int i = 0; i < PERSIST_KEYS; i++) {
+		if (s_persist[i].used && s_persist[i].key == key) {
+			return &s_persist[i];
+		}
+	}
+	return NULL;
+}
+
+static int writeEntry(uint32_t key, const void *data, int size) {
+	if (size < 0 || size > PERSIST_DATA_MAX_LENGTH) {
+		return -1;
+	}
+	PersistEntry *entry = findEntry(key);
+	for (int i = 0; !entry && i < PERSIST_KEYS; i++) {
+		if (!s_persist[i].used) {
+			entry = &s_persist[i];
+		}
+	}
+	if (!entry) {
+		return -1;
+	}
+	entry->used = true;
+	entry->key = key;
+	entry->size = size;
+	memcpy(entry->data, data, size);
+	return size;
+}
+
+void shim_persist_set_raw(uint32_t key, const void *data, int size) {
+	writeEntry(key, data, size);
+}
+
+void shim_persist_clear(void) {
+	memset(s_persist, 0, sizeof(s_persist));
+}
+
+bool persist_exists(const uint32_t key) {
+	shim_stats.persist_reads++;
+	return findEntry(key) != NULL;
+}
+
+int persist_get_size(const uint32_t key) {
+	shim_stats.persist_reads++;
+	PersistEntry *entry = findEntry(key);
+	return entry ? entry->size : E_DOES_NOT_EXIST;
+}
+
+bool persist_read_bool(const uint32_t key) {
+	shim_stats.persist_reads++;
+	PersistEntry *entry = findEntry(key);
+	return entry && entry->size >= 1 && entry->data[0] != 0;
+}
+
+int32_t persist_read_int(const uint32_t key) {
+	shim_stats.persist_reads++;
+	PersistEntry *entry = findEntry(key);
+	int32_t value = 0;
+	if (entry && entry->size >= (int) sizeof(value)) {
+		memcpy(&value, entry->data, sizeof(value));
+	}
+	return value;
+}
+
+int persist_read_data(const uint32_t key, void *buffer, const size_t buffer_size) {
+	shim_stats.persist_reads++;
+	PersistEntry *entry = findEntry(key);
+	if (!entry) {
+		return E_DOES_NOT_EXIST;
+	}
+	int size = entry->size < (int) buffer_size ? entry->size : (int) buffer_size;
+	memcpy(buffer, entry->data, size);
+	return size;
+}
+
+// Truncated to the buffer and always terminated, like the SDK
+int persist_read_string(const uint32_t key, char *buffer, const size_t buffer_size) {
+	shim_stats.persist_reads++;
+	PersistEntry *entry = findEntry(key);
+	if (!entry) {
+		return E_DOES_NOT_EXIST;
+	}
+	if (buffer_size == 0) {
+		return 0;
+	}
+	int size = entry->size < (int) buffer_size ? entry->size : (int) buffer_size;
+	memcpy(buffer, entry->data, size);
+	buffer[size < (int) buffer_size ? size : (int) buffer_size - 1] = '\0';
+	return size;
+}
+
+int persist_write_bool(const uint32_t key, const bool value) {
+	shim_stats.persist_writes++;
+	uint8_t byte = value;
+	return writeEntry(key, &byte, 1);
+}
+
+int persist_write_int(const uint32_t key, const int32_t value) {
+	shim_stats.persist_writes++;
+	return writeEntry(key, &value, sizeof(value));
+}
+
+int persist_write_data(const uint32_t key, const void *data, const size_t size) {
+	shim_stats.persist_writes++;
+	return writeEntry(key, data, (int) size);
+}
+
+int persist_write_string(const uint32_t key, const char *cstring) {
+	shim_stats.persist_writes++;
+	return writeEntry(key, cstring, (int) strlen(cstring) + 1);
+}
+
+int persist_delete(const uint32_t key) {
+	shim_stats.persist_deletes++;
+	PersistEntry *entry = findEntry(key);
+	if (!entry) {
+		return E_DOES_NOT_EXIST;
+	}
+	entry->used = false;
+	return 0;
+}
+
+// App
+
+size_t heap_bytes_used(void) {
+	return 0;
+}
+
+size_t heap_bytes_free(void) {
+	return 0;
+}
+
+void app_event_loop(void) {
+}
+
+// Harness state
+
+void shim_reset_stats(void) {
+	memset(&shim_stats, 0, sizeof(shim_stats));
+}
+
+int shim_live(ShimKind kind) {
+	return shim_stats.created[kind] - shim_stats.destroyed[kind];
+}
+
+void shim_reset(void) {
+	while (s_timers) {
+		AppTimer *next = s_timers->next;
+		free(s_timers);
+		s_timers = next;
+	}
+	while (s_animations) {
+		Animation *next = s_animations->next;
+		free(s_animations);
+		s_animations = next;
+	}
+	s_window_count = 0;
+	s_tick_handler = NULL;
+	s_tick_units = 0;
+	s_tap_handler = NULL;
+	s_bt_handler = NULL;
+	s_battery_handler = NULL;
+	s_battery = (BatteryChargeState) { .charge_percent = 100 };
+	s_inbox_received = NULL;
+	s_inbox_dropped = NULL;
+	s_vibes = 0;
+	s_last_vibe_segments = 0;
+	s_dirty = false;
+	shim_persist_clear();
+	memset(s_frame_data, 0, sizeof(s_frame_data));
+	shim_reset_stats();
+}
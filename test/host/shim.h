@@ -0,0 +1,123 @@
+// Harness side of the pebble.h shim: drives time, services and rendering,
+// and exposes what pebble_stub.c counted. Only the tests include this.
+
+#pragma once
+
+#include "pebble.h"
+
+// Screen of the platform the harness was built for
+#if defined(PBL_PLATFORM_EMERY)
+#define SHIM_SCREEN_W 200
+#define SHIM_SCREEN_H 228
+#elif defined(PBL_ROUND)
+#define SHIM_SCREEN_W 180
+#define SHIM_SCREEN_H 180
+#else
+#define SHIM_SCREEN_W 144
+#define SHIM_SCREEN_H 168
+#endif
+
+typedef enum {
+	SK_WINDOW,
+	SK_LAYER,
+	SK_TEXT_LAYER,
+	SK_GBITMAP,
+	SK_GPATH,
+	SK_ANIMATION,
+	SK_APP_TIMER,
+	SK_COUNT
+} ShimKind;
+
+extern const char *const SHIM_KIND_NAMES[SK_COUNT];
+
+typedef struct {
+	// Drawing primitives, as called by the app
+	int fill_circle;
+	int gpath_draw_filled;
+	int gpath_draw_outline;
+	int draw_text;
+	int draw_bitmap;
+	int capture_frame_buffer;
+	// Invalidation and rendering
+	int layer_mark_dirty;
+	int frames;
+	int layer_renders;
+	int text_layer_renders;
+	// Storage
+	int persist_reads;
+	int persist_writes;
+	int persist_deletes;
+	// Timers, ticks and vibes
+	int timer_registers;
+	int timer_reschedules;
+	int timer_cancels;
+	int timer_fires;
+	int ticks;
+	int tick_subscribes;
+	int vibes;
+	// Objects
+	int created[SK_COUNT];
+	int destroyed[SK_COUNT];
+} ShimStats;
+
+extern ShimStats shim_stats;
+
+// Clears the counters, not the state
+void shim_reset_stats(void);
+
+// Forgets every window, subscription, timer, animation and stored key
+void shim_reset(void);
+
+// Harness clock, in seconds since the epoch and treated as local time
+void shim_set_time(time_t now);
+time_t shim_get_time(void);
+
+// Moves the clock forward, firing timers and running animations on the way
+// and rendering whenever something was marked dirty
+void shim_advance_ms(uint32_t ms);
+
+// Delivers the tick for the current time if the subscribed unit changed.
+// Returns whether a tick went out.
+bool shim_tick(void);
+
+void shim_tap(void);
+void shim_set_battery(BatteryChargeState state);
+void shim_set_bluetooth(bool connected);
+
+// Redraws the top window if anything was marked dirty since the last frame
+bool shim_render_if_dirty(void);
+// Redraws the top window unconditionally
+void shim_render(void);
+
+// The screen, one GColor8 per pixel whatever the platform's format; pixels
+// outside a round display read as 0
+uint8_t shim_get_pixel(int x, int y);
+GBitmap *shim_frame_buffer(void);
+
+// How often a layer's update proc ran
+int shim_layer_renders(const Layer *layer);
+
+// Storage
+void shim_persist_set_raw(uint32_t key, const void *data, int size);
+void shim_persist_clear(void);
+
+// Messages: a dictionary the tests fill and hand to the inbox handler
+#define SHIM_DICT_BYTES 256
+struct DictionaryIterator {
+	uint8_t buffer[SHIM_DICT_BYTES];
+	int used;
+};
+void shim_dict_init(DictionaryIterator *iter);
+void shim_dict_add_data(DictionaryIterator *iter, uint32_t key, const uint8_t *data, uint16_t length);
+void shim_dict_add_int32(DictionaryIterator *iter, uint32_t key, int32_t value);
+void shim_deliver_message(DictionaryIterator *iter);
+
+// Vibration log
+int shim_vibe_count(void);
+uint32_t shim_last_vibe_segments(void);
+
+// Timers that have not fired or been cancelled
+int shim_pending_timers(void);
+
+// Live objects of a kind: created minus destroyed
+int shim_live(ShimKind kind);
@@ -0,0 +1,165 @@
+// The dial cache must never show on screen: after every event a frame drawn
+// with the cache is compared pixel by pixel against one drawn without it.
+// Built for each platform, this covers the whole-row copy of the 8-bit and
+// 1-bit (aplite) frame buffers and the row_info copy of round ones (chalk).
+
+#include "macro_clock.h"
+
+static uint8_t s_cached[SHIM_SCREEN_H][SHIM_SCREEN_W];
+static int s_blits;
+static int s_checks;
+
+static int persistCalls() {
+	return shim_stats.persist_reads + shim_stats.persist_writes + shim_stats.persist_deletes;
+}
+
+// Redraws with the cache as it stands, then without it, and compares. Neither
+// frame may touch storage.
+static void expectCacheInvisible(const char *what, bool expectBlit) {
+	int blits = shim_stats.draw_bitmap;
+	int persist = persistCalls();
+	shim_render();
+	bool blitted = shim_stats.draw_bitmap > blits;
+	s_blits += blitted;
+	if (expectBlit) {
+		EXPECT(blitted, "%s: the cache was not used", what);
+	}
+	for (int y = 0; y < SHIM_SCREEN_H; y++) {
+		for (int x = 0; x < SHIM_SCREEN_W; x++) {
+			s_cached[y][x] = shim_get_pixel(x, y);
+		}
+	}
+
+	GBitmap *cache = s_dial_cache;
+	s_dial_cache = NULL;
+	shim_render();
+	s_dial_cache = cache;
+	EXPECT(persistCalls() == persist, "%s: %d persist calls while rendering", what, persistCalls() - persist);
+
+	int diff = 0;
+	int firstX = -1;
+	int firstY = -1;
+	for (int y = 0; y < SHIM_SCREEN_H; y++) {
+		for (int x = 0; x < SHIM_SCREEN_W; x++) {
+			if (shim_get_pixel(x, y) != s_cached[y][x]) {
+				if (!diff) {
+					firstX = x;
+					firstY = y;
+				}
+				diff++;
+			}
+		}
+	}
+	EXPECT(diff == 0, "%s: %d pixels differ from the direct draw, first at (%d, %d)", what, diff, firstX, firstY);
+	s_checks++;
+}
+
+static void alwaysOn(Settings *settings) {
+	settings->dateToggle = DT_ALWAYS_ON;
+	settings->digTimeToggle = DT_ALWAYS_ON;
+}
+
+// Three hours over the 12 o'clock numeral change. Odd minutes only change the
+// digital time, so their frames are blits of the cache.
+static void testMinutes() {
+	startApp(HOST_START_TIME + 10 * 3600, alwaysOn);
+	char what[32];
+	for (int minute = 0; minute < 180; minute++) {
+		runMinute();
+		snprintf(what, sizeof(what), "minute %d", minute + 1);
+		expectCacheInvisible(what, true);
+	}
+	stopApp();
+}
+
+// A tap reveal redraws the dial for its separator lines, from the cache
+static void testTapReveal() {
+	startApp(HOST_START_TIME + 15 * 3600 + 7 * 60, NULL);
+	shim_tap();
+	expectCacheInvisible("tap reveal", true);
+	shim_advance_ms(REVEAL_MS);
+	expectCacheInvisible("tap hide", true);
+	stopApp();
+}
+
+static void testColors() {
+	startApp(HOST_START_TIME + 9 * 3600 + 41 * 60, NULL);
+	expectCacheInvisible("start", true);
+
+	const uint8_t dots[] = { MK_DOT_COLOR, GColorRedARGB8 };
+	sendConfig(dots, sizeof(dots));
+	expectCacheInvisible("dot color", true);
+
+	const uint8_t hours[] = { MK_HOUR_COLOR, GColorYellowARGB8 };
+	sendConfig(hours, sizeof(hours));
+	expectCacheInvisible("hour color", true);
+
+	const uint8_t background[] = { MK_BACKGROUND_COLOR, GColorWhiteARGB8 };
+	sendConfig(background, sizeof(background));
+	expectCacheInvisible("background color", true);
+
+	// The hand is drawn over the cache, never into it
+	const uint8_t hand[] = { MK_HAND_COLOR, GColorDukeBlueARGB8, MK_HAND_OUTLINE_BOOL, 0 };
+	sendConfig(hand, sizeof(hand));
+	expectCacheInvisible("hand", true);
+	stopApp();
+}
+
+// 13:00 reads 13 or 1 depending on the format
+static void testHourFormat() {
+	startApp(HOST_START_TIME + 13 * 3600 + 20 * 60, NULL);
+	expectCacheInvisible("24 hour", true);
+
+	const uint8_t twelve[] = { MK_HOUR_FORMAT, 1 };
+	sendConfig(twelve, sizeof(twelve));
+	expectCacheInvisible("12 hour", true);
+
+	const uint8_t twentyFour[] = { MK_HOUR_FORMAT, 0 };
+	sendConfig(twentyFour, sizeof(twentyFour));
+	expectCacheInvisible("24 hour again", true);
+	stopApp();
+}
+
+// The tiers draw different dots into the cache
+static void testTiers() {
+	startApp(HOST_START_TIME + 20 * 3600 + 3 * 60, NULL);
+	expectCacheInvisible("full", true);
+
+	shim_set_battery((BatteryChargeState) { .charge_percent = 20 });
+	EXPECT(s_tier == RT_REDUCED, "20%% gave tier %d", s_tier);
+	expectCacheInvisible("reduced", true);
+
+	shim_set_battery((BatteryChargeState) { .charge_percent = 5 });
+	EXPECT(s_tier == RT_MINIMAL, "5%% gave tier %d", s_tier);
+	expectCacheInvisible("minimal", true);
+
+	shim_set_battery((BatteryChargeState) { .charge_percent = 5, .is_charging = true });
+	EXPECT(s_tier == RT_FULL, "charging gave tier %d", s_tier);
+	expectCacheInvisible("charging", true);
+	stopApp();
+}
+
+// Night frames skip the cache; the day face after them must not pick up a stale one
+static void testNight() {
+	startApp(HOST_START_TIME + 2 * 3600 + 30 * 60, NULL);
+	const uint8_t night[] = { MK_NIGHT_MODE, 1 };
+	sendConfig(night, sizeof(night));
+	EXPECT(s_night, "2:30 is not night");
+	expectCacheInvisible("night", false);
+
+	shim_tap();
+	EXPECT(!s_night, "a tap did not wake the face");
+	expectCacheInvisible("woken", true);
+	stopApp();
+}
+
+int main(void) {
+	testMinutes();
+	testTapReveal();
+	testColors();
+	testHourFormat();
+	testTiers();
+	testNight();
+	EXPECT(s_blits > s_checks / 2, "only %d of %d checks blitted the cache", s_blits, s_checks);
+	return hostResult("dial_cache");
+}
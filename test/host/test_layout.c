@@ -0,0 +1,83 @@
+// computeLayout for every minute of a day in both hour formats, against
+// host/golden/layout_<screen>.txt. After an intended layout change,
+// `make -C test golden` rewrites the files; review their diff like code.
+
+#include "macro_clock.h"
+
+#include <stdlib.h>
+
+// One file per geometry table; aplite shares basalt's screen and table
+#if defined(PBL_PLATFORM_EMERY)
+#define GOLDEN_PATH "host/golden/layout_emery.txt"
+#elif defined(PBL_PLATFORM_CHALK)
+#define GOLDEN_PATH "host/golden/layout_chalk.txt"
+#else
+#define GOLDEN_PATH "host/golden/layout_basalt.txt"
+#endif
+#define LINE_SIZE 256
+
+static void formatLayout(char *line, const struct tm *tick_time, bool hourFormat, const DialLayout *layout) {
+	snprintf(line, LINE_SIZE,
+		"%02d:%02d %s hour=\"%s\" next=\"%s\" date=\"%s\" time=\"%s\" path=%ld hour_angle=%ld "
+		"frame=%d,%d,%d,%d next_frame=%d,%d,%d,%d\n",
+		tick_time->tm_hour, tick_time->tm_min, hourFormat ? "24h" : "12h",
+		layout->hour, layout->nextHour, layout->date, layout->digitalTime,
+		(long) layout->pathAngle, (long) layout->hourAngle,
+		layout->hourFrame.origin.x, layout->hourFrame.origin.y,
+		layout->hourFrame.size.w, layout->hourFrame.size.h,
+		layout->nextHourFrame.origin.x, layout->nextHourFrame.origin.y,
+		layout->nextHourFrame.size.w, layout->nextHourFrame.size.h);
+}
+
+int main(void) {
+	bool update = getenv("UPDATE_GOLDEN") != NULL;
+	FILE *golden = fopen(GOLDEN_PATH, update ? "w" : "r");
+	if (!golden) {
+		fprintf(stderr, "cannot open %s\n", GOLDEN_PATH);
+		return 1;
+	}
+
+	// main_window_load sets the screen geometry computeLayout works from
+	startApp(HOST_START_TIME, NULL);
+
+	Settings settings = s_settings;
+	int lines = 0;
+	int mismatches = 0;
+	for (int format = 0; format < 2; format++) {
+		settings.hourFormat = format;
+		for (int minute = 0; minute < 24 * 60; minute++) {
+			time_t when = HOST_START_TIME + minute * 60;
+			struct tm tick_time;
+			gmtime_r(&when, &tick_time);
+
+			DialLayout layout;
+			computeLayout(&tick_time, &settings, &layout);
+			char line[LINE_SIZE];
+			formatLayout(line, &tick_time, settings.hourFormat, &layout);
+			lines++;
+
+			if (update) {
+				fputs(line, golden);
+				continue;
+			}
+			char expected[LINE_SIZE];
+			if (!fgets(expected, sizeof(expected), golden)) {
+				expected[0] = '\0';
+			}
+			if (strcmp(line, expected) != 0 && mismatches++ < 10) {
+				EXPECT(false, "line %d\n  expected %s  got      %s", lines, expected, line);
+			}
+		}
+	}
+	char extra[LINE_SIZE];
+	EXPECT(update || !fgets(extra, sizeof(extra), golden), "%s has more than %d lines", GOLDEN_PATH, lines);
+	EXPECT(mismatches == 0, "%d of %d lines differ from %s", mismatches, lines, GOLDEN_PATH);
+
+	stopApp();
+	fclose(golden);
+	if (update) {
+		printf("layout: wrote %d lines to %s\n", lines, GOLDEN_PATH);
+		return 0;
+	}
+	return hostResult("layout");
+}
@@ -0,0 +1,54 @@
+// 1000 launches and exits of the face, each leaving something in flight:
+// a hand glide, a reveal timer or both. Every kind of object the shim hands
+// out has to be destroyed as often as it was created, after every cycle.
+
+#include "macro_clock.h"
+
+#define CYCLES 1000
+
+static void smoothFlick(Settings *settings) {
+	settings->smoothMotion = true;
+	settings->dateToggle = DT_FLICK;
+}
+
+static int s_imbalances;
+
+static void expectBalanced(int cycle) {
+	for (int kind = 0; kind < SK_COUNT; kind++) {
+		if (shim_live(kind) != 0 && s_imbalances++ < 10) {
+			EXPECT(false, "cycle %d: %d %s objects left (%d created, %d destroyed)", cycle,
+				shim_live(kind), SHIM_KIND_NAMES[kind], shim_stats.created[kind], shim_stats.destroyed[kind]);
+		}
+	}
+}
+
+int main(void) {
+	shim_reset();
+	for (int cycle = 0; cycle < CYCLES; cycle++) {
+		storeSettings(smoothFlick);
+		shim_set_time(HOST_START_TIME + cycle * 3600);
+		init();
+		shim_render_if_dirty();
+
+		// The tick starts a glide, which half the cycles let finish, and the
+		// tap a reveal timer that is still pending at exit
+		runMinute();
+		if (cycle % 3 != 2) {
+			shim_tap();
+		}
+		if (cycle % 2) {
+			shim_advance_ms(SMOOTH_DURATION_MS + 100);
+		}
+		stopApp();
+		expectBalanced(cycle);
+	}
+
+	printf("%-10s %8s %8s\n", "kind", "created", "destroyed");
+	for (int kind = 0; kind < SK_COUNT; kind++) {
+		printf("%-10s %8d %8d\n", SHIM_KIND_NAMES[kind], shim_stats.created[kind], shim_stats.destroyed[kind]);
+		EXPECT(shim_stats.created[kind] > 0, "no %s was ever created, so its balance proves nothing",
+			SHIM_KIND_NAMES[kind]);
+	}
+	EXPECT(s_imbalances == 0, "%d imbalances in %d cycles", s_imbalances, CYCLES);
+	return hostResult("leaks");
+}
@@ -0,0 +1,95 @@
+// The disconnect alert and quiet hours. A schedule rebuilt from the chime
+// window, whether by default, from older settings or from MK_VIBE_START/END,
+// must not silence the alert; one sent as MK_QUIET_HOURS does, until the
+// chime times are set again.
+
+#include "macro_clock.h"
+
+// Monday 3:00, quiet in the default schedule, and Monday 12:00, not quiet
+#define QUIET_TIME (HOST_START_TIME + 3 * 3600)
+#define LOUD_TIME (HOST_START_TIME + 12 * 3600)
+
+static void btAlert(Settings *settings) {
+	settings->btAlertToggle = true;
+}
+
+// Whether a disconnect at when vibrates
+static bool alerts(time_t when) {
+	shim_set_time(when);
+	int before = shim_vibe_count();
+	shim_set_bluetooth(false);
+	shim_set_bluetooth(true);
+	return shim_vibe_count() > before;
+}
+
+// Quiet all of Monday, nothing else
+static void sendSchedule() {
+	uint8_t bits[QUIET_HOURS_SIZE] = { 0 };
+	memset(bits + 3, 0xFF, 3);
+	DictionaryIterator iter;
+	shim_dict_init(&iter);
+	shim_dict_add_data(&iter, MK_QUIET_HOURS, bits, sizeof(bits));
+	shim_deliver_message(&iter);
+}
+
+static void testMessages() {
+	startApp(LOUD_TIME, btAlert);
+	EXPECT(!s_settings.quietHoursSet, "default schedule counts as set");
+	EXPECT(alerts(QUIET_TIME), "default schedule silenced the alert");
+
+	static const uint8_t START[] = { MK_VIBE_START, 9 };
+	sendConfig(START, sizeof(START));
+	EXPECT(quietHoursContains(&s_settings.quietHours, 1, 3), "chime window not rebuilt");
+	EXPECT(alerts(QUIET_TIME), "chime window silenced the alert");
+
+	sendSchedule();
+	EXPECT(s_settings.quietHoursSet, "MK_QUIET_HOURS did not set the schedule");
+	EXPECT(!alerts(QUIET_TIME), "schedule did not silence the alert");
+	EXPECT(alerts(QUIET_TIME + 24 * 3600), "alert silenced outside the schedule");
+
+	// Saved, and still set after a relaunch
+	stopApp();
+	init();
+	EXPECT(s_settings.quietHoursSet && !alerts(QUIET_TIME), "schedule lost on relaunch");
+
+	static const uint8_t END[] = { MK_VIBE_END, 22 };
+	sendConfig(END, sizeof(END));
+	EXPECT(!s_settings.quietHoursSet, "MK_VIBE_END kept the schedule");
+	EXPECT(alerts(QUIET_TIME), "rebuilt chime window silenced the alert");
+	stopApp();
+}
+
+// A version 4 blob has no flag; only a mask unlike the chime window was sent
+static void loadVersion4(bool custom) {
+	setDefaultSettings();
+	s_settings.btAlertToggle = true;
+	if (custom) {
+		quietHoursAddWindow(&s_settings.quietHours, 1, 12, 13);
+	}
+	StoredSettings stored;
+	packSettings(&stored, &s_settings);
+	stored.version = 4;
+	shim_reset();
+	shim_persist_set_raw(PK_SETTINGS, &stored, offsetof(StoredSettings, quietHoursSet));
+	shim_set_time(LOUD_TIME);
+	init();
+	shim_reset_stats();
+}
+
+static void testMigration() {
+	loadVersion4(false);
+	EXPECT(!s_settings.quietHoursSet, "v4 chime window loaded as a schedule");
+	EXPECT(alerts(QUIET_TIME), "v4 chime window silenced the alert");
+	stopApp();
+
+	loadVersion4(true);
+	EXPECT(s_settings.quietHoursSet, "v4 schedule loaded as a chime window");
+	EXPECT(!alerts(QUIET_TIME), "v4 schedule did not silence the alert");
+	stopApp();
+}
+
+int main(void) {
+	testMessages();
+	testMigration();
+	return hostResult("quiet_hours");
+}
@@ -0,0 +1,156 @@
+// loadSettings over corrupted storage. Each round fills the legacy per-key
+// settings, or the settings blob, with random sizes and bytes; whatever
+// loads has to be in range for the draw and tick paths, and the face has to
+// start and run on it.
+
+#include "macro_clock.h"
+
+#include <stdlib.h>
+
+#define ROUNDS 20000
+#define MAX_VALUE_SIZE 8
+
+static uint32_t s_seed = 12345;
+
+static uint32_t nextRandom() {
+	s_seed = s_seed * 1103515245 + 12345;
+	return s_seed >> 8;
+}
+
+static const char *const STRINGS[] = { "blk", "wht", "red", "gry", "08a", "12a", "11p", "00a", "13p", "", "xyz" };
+
+// Mostly junk, sometimes a value of the right kind, so parsing gets past the size checks
+static int randomValue(uint8_t *value) {
+	switch (nextRandom() % 4) {
+		case 0: {
+			const char *string = STRINGS[nextRandom() % ARRAY_LENGTH(STRINGS)];
+			memcpy(value, string, strlen(string) + 1);
+			return strlen(string) + 1;
+		}
+		case 1:
+			value[0] = nextRandom() % 3;
+			return 1;
+		case 2: {
+			int32_t number = nextRandom() % 5 == 0 ? (int32_t) nextRandom() : (int32_t) (nextRandom() % 4) - 1;
+			memcpy(value, &number, sizeof(number));
+			return sizeof(number);
+		}
+		default: {
+			int size = nextRandom() % (MAX_VALUE_SIZE + 1);
+			for (int i = 0; i < size; i++) {
+				value[i] = nextRandom();
+			}
+			return size;
+		}
+	}
+}
+
+static void fillLegacyKeys() {
+	for (uint32_t key = MK_BACKGROUND_COLOR; key <= MK_HAND_OUTLINE_BOOL; key++) {
+		if (nextRandom() % 4 == 0) {
+			continue;
+		}
+		uint8_t value[MAX_VALUE_SIZE];
+		int size = randomValue(value);
+		shim_persist_set_raw(key, value, size);
+	}
+}
+
+// Random bytes under a version that sometimes passes the check
+static void fillBlob() {
+	uint8_t blob[sizeof(StoredSettings) + 4];
+	int size = nextRandom() % sizeof(blob);
+	for (int i = 0; i < size; i++) {
+		blob[i] = nextRandom();
+	}
+	if (size > 0 && nextRandom() % 2) {
+		blob[0] = 1 + nextRandom() % SETTINGS_VERSION;
+	}
+	shim_persist_set_raw(PK_SETTINGS, blob, size);
+}
+
+static bool isLegacyColor(GColor color) {
+	for (unsigned int i = 0; i < ARRAY_LENGTH(LEGACY_COLORS); i++) {
+		if (color.argb == LEGACY_COLORS[i].argb) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool isBool(bool value) {
+	uint8_t byte;
+	memcpy(&byte, &value, 1);
+	return byte <= 1;
+}
+
+static void expectInRange(int round, bool legacy) {
+	EXPECT(s_settings.vibeStartTime >= 0 && s_settings.vibeStartTime < 24, "round %d: start %d", round, s_settings.vibeStartTime);
+	EXPECT(s_settings.vibeEndTime >= 0 && s_settings.vibeEndTime < 24, "round %d: end %d", round, s_settings.vibeEndTime);
+	EXPECT(s_settings.dateToggle >= DT_OFF && s_settings.dateToggle <= DT_ALWAYS_ON, "round %d: date toggle %d", round, s_settings.dateToggle);
+	EXPECT(s_settings.digTimeToggle >= DT_OFF && s_settings.digTimeToggle <= DT_ALWAYS_ON, "round %d: time toggle %d", round, s_settings.digTimeToggle);
+	EXPECT(s_settings.chimePattern >= 0 && s_settings.chimePattern < CP_COUNT, "round %d: chime %d", round, s_settings.chimePattern);
+	EXPECT(isBool(s_settings.handBorderToggle) && isBool(s_settings.vibeToggle) && isBool(s_settings.hourFormat) &&
+		isBool(s_settings.btAlertToggle) && isBool(s_settings.smoothMotion) && isBool(s_settings.nightMode) &&
+		isBool(s_settings.quietHoursSet),
+		"round %d: a toggle is not 0 or 1", round);
+	// Legacy keys only ever held the named colors; the blob may hold any
+	// ARGB8 byte, all of which the draw path takes
+	if (legacy) {
+		EXPECT(isLegacyColor(s_settings.backgroundColor) && isLegacyColor(s_settings.hourColor) &&
+			isLegacyColor(s_settings.handColor) && isLegacyColor(s_settings.dotColor) &&
+			isLegacyColor(s_settings.handBorderColor), "round %d: a color is not a legacy color", round);
+	}
+}
+
+int main(void) {
+	int failuresBefore = 0;
+	// Rounds that loaded something other than the defaults, so the checks saw real values
+	int loadedLegacy = 0;
+	int loadedBlob = 0;
+	setDefaultSettings();
+	Settings defaults = s_settings;
+	for (int round = 0; round < ROUNDS && s_host_failures < 20; round++) {
+		shim_reset();
+		bool legacy = nextRandom() % 2;
+		if (legacy) {
+			fillLegacyKeys();
+		}
+		else {
+			fillBlob();
+		}
+
+		loadSettings();
+		expectInRange(round, legacy);
+		if (!settingsEqual(&defaults, &s_settings)) {
+			legacy ? loadedLegacy++ : loadedBlob++;
+		}
+
+		// Migration leaves the blob and nothing else
+		for (uint32_t key = MK_BACKGROUND_COLOR; legacy && key <= MK_HAND_OUTLINE_BOOL; key++) {
+			EXPECT(!persist_exists(key), "round %d: legacy key %d kept", round, (int) key);
+		}
+		// What was loaded reads back the same
+		Settings loaded = s_settings;
+		loadSettings();
+		EXPECT(settingsEqual(&loaded, &s_settings), "round %d: settings changed on reload", round);
+
+		// Every hundredth round runs the face on what was loaded
+		if (round % 100 == 0) {
+			shim_set_time(HOST_START_TIME + round * 600);
+			init();
+			for (int minute = 0; minute < 3; minute++) {
+				runMinute();
+			}
+			shim_tap();
+			stopApp();
+		}
+		if (s_host_failures > failuresBefore) {
+			fprintf(stderr, "round %d was %s\n", round, legacy ? "legacy keys" : "a blob");
+			failuresBefore = s_host_failures;
+		}
+	}
+	printf("%d rounds, non-default settings from %d legacy and %d blob rounds\n", ROUNDS, loadedLegacy, loadedBlob);
+	EXPECT(loadedLegacy > ROUNDS / 10 && loadedBlob > ROUNDS / 10, "too few rounds got past the checks");
+	return hostResult("settings_fuzz");
+}
@@ -0,0 +1,71 @@
+// A burst of taps keeps one reveal timer: the first tap registers it, every
+// later one pushes it back, and the flick lines hide REVEAL_MS after the
+// last tap, to the millisecond.
+
+#include "macro_clock.h"
+
+#define TAPS 100
+
+static void bothFlick(Settings *settings) {
+	settings->dateToggle = DT_FLICK;
+	settings->digTimeToggle = DT_FLICK;
+}
+
+static void testBurst() {
+	startApp(HOST_START_TIME + 8 * 3600 + 12 * 60, bothFlick);
+	EXPECT(layer_get_hidden(dateLayer) && layer_get_hidden(dateLayer2), "flick lines shown before a tap");
+
+	// Gaps from nothing up to just under REVEAL_MS, so the timer never fires mid-burst
+	for (int tap = 0; tap < TAPS; tap++) {
+		if (tap > 0) {
+			shim_advance_ms((tap * 7919) % REVEAL_MS);
+		}
+		shim_tap();
+		EXPECT(!layer_get_hidden(dateLayer) && !layer_get_hidden(dateLayer2), "tap %d: lines hidden", tap);
+		EXPECT(shim_pending_timers() == 1, "tap %d: %d timers pending", tap, shim_pending_timers());
+	}
+#ifdef MACRO_CLOCK_PROFILE
+	// The burst is timed on the real clock; drawing a frame takes some of it
+	EXPECT(s_profile_count[PS_TAP] == PROFILE_SAMPLES, "%d tap samples", s_profile_count[PS_TAP]);
+	uint16_t slowest = 0;
+	for (int i = 0; i < s_profile_count[PS_DIAL_LAYER]; i++) {
+		slowest = s_profile_samples[PS_DIAL_LAYER][i] > slowest ? s_profile_samples[PS_DIAL_LAYER][i] : slowest;
+	}
+	EXPECT(slowest > 0, "every dial draw timed at 0 " PROFILE_UNIT);
+#endif
+	EXPECT(shim_stats.timer_registers == 1, "%d timers registered", shim_stats.timer_registers);
+	EXPECT(shim_stats.timer_reschedules == TAPS - 1, "%d reschedules", shim_stats.timer_reschedules);
+
+	shim_advance_ms(REVEAL_MS - 1);
+	EXPECT(!layer_get_hidden(dateLayer), "date line hidden 1 ms early");
+	EXPECT(!layer_get_hidden(dateLayer2), "time line hidden 1 ms early");
+	shim_advance_ms(1);
+	EXPECT(layer_get_hidden(dateLayer), "date line still shown at REVEAL_MS");
+	EXPECT(layer_get_hidden(dateLayer2), "time line still shown at REVEAL_MS");
+	EXPECT(shim_stats.timer_fires == 1, "%d timer fires", shim_stats.timer_fires);
+	EXPECT(shim_pending_timers() == 0, "%d timers left", shim_pending_timers());
+
+	// The next tap after the timer fired starts a new one
+	shim_tap();
+	EXPECT(shim_stats.timer_registers == 2, "no new timer after the reveal ended");
+	stopApp();
+}
+
+// Only a flick line is revealed and hidden; one that is always on stays put
+static void testMixed() {
+	startApp(HOST_START_TIME + 8 * 3600 + 12 * 60, NULL);
+	s_settings.digTimeToggle = DT_ALWAYS_ON;
+	showDateLines();
+
+	shim_tap();
+	shim_advance_ms(REVEAL_MS);
+	EXPECT(layer_get_hidden(dateLayer), "flick date line still shown");
+	EXPECT(!layer_get_hidden(dateLayer2), "always-on time line hidden");
+	stopApp();
+}
+
+int main(void) {
+	testBurst();
+	testMixed();
+	return hostResult("tap");
+}
@@ -0,0 +1,109 @@
+// text_format.c against the strftime formats it replaced, for every minute
+// of 2024 in both hour formats. Every buffer is allocated at exactly the
+// declared capacity, so the sanitizer catches a single byte written past it.
+// Out of range struct tm fields have no strftime answer; they must wrap.
+
+#include "host_test.h"
+#include "text_format.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define YEAR_MINUTES (366 * 24 * 60)
+
+static char *s_numeral;
+static char *s_date;
+static char *s_time;
+
+// The numerals were "%H" or "%I" with the leading zero cut off
+static void expectNumeral(int hour, bool hourFormat) {
+	struct tm tick_time = { .tm_hour = ((hour % 24) + 24) % 24 };
+	char expected[8];
+	strftime(expected, sizeof(expected), hourFormat ? "%H" : "%I", &tick_time);
+	const char *trimmed = expected[0] == '0' && expected[1] ? expected + 1 : expected;
+	formatNumeral(s_numeral, hour, hourFormat);
+	EXPECT(strcmp(s_numeral, trimmed) == 0, "hour %d %s: \"%s\", strftime \"%s\"",
+		hour, hourFormat ? "24h" : "12h", s_numeral, trimmed);
+}
+
+static void expectTexts(const struct tm *tick_time) {
+	char expected[32];
+	strftime(expected, sizeof(expected), "%a, %b %e", tick_time);
+	formatDate(s_date, tick_time);
+	EXPECT(strcmp(s_date, expected) == 0, "date \"%s\", strftime \"%s\"", s_date, expected);
+
+	strftime(expected, sizeof(expected), "%H:%M", tick_time);
+	formatDigitalTime(s_time, tick_time, true);
+	EXPECT(strcmp(s_time, expected) == 0, "24h time \"%s\", strftime \"%s\"", s_time, expected);
+
+	strftime(expected, sizeof(expected), "%l:%M %p", tick_time);
+	formatDigitalTime(s_time, tick_time, false);
+	EXPECT(strcmp(s_time, expected) == 0, "12h time \"%s\", strftime \"%s\"", s_time, expected);
+}
+
+static void testYear() {
+	for (int minute = 0; minute < YEAR_MINUTES && s_host_failures < 20; minute++) {
+		time_t when = HOST_START_TIME + (time_t) minute * 60;
+		struct tm tick_time;
+		gmtime_r(&when, &tick_time);
+		expectTexts(&tick_time);
+		if (tick_time.tm_min == 0) {
+			// computeLayout also asks for the hour after, 24 included
+			for (int format = 0; format < 2; format++) {
+				expectNumeral(tick_time.tm_hour, format);
+				expectNumeral(tick_time.tm_hour + 1, format);
+			}
+		}
+	}
+}
+
+static int wrap(int value, int range) {
+	return ((value % range) + range) % range;
+}
+
+// Whatever is in the fields, the text is the one of the wrapped fields and fits
+static void testOutOfRange() {
+	static const int VALUES[] = { -2147483647 - 1, -1000, -25, -13, -8, -1, 0, 1, 7, 12, 13, 23, 24, 25,
+		31, 59, 60, 61, 99, 100, 1000, 2147483647 };
+	for (unsigned int i = 0; i < sizeof(VALUES) / sizeof(VALUES[0]); i++) {
+		for (unsigned int j = 0; j < sizeof(VALUES) / sizeof(VALUES[0]); j++) {
+			int a = VALUES[i];
+			int b = VALUES[j];
+			struct tm wild = { .tm_min = a, .tm_hour = b, .tm_mday = a, .tm_mon = b, .tm_wday = a };
+			struct tm wrapped = { .tm_min = wrap(a, 60), .tm_hour = wrap(b, 24), .tm_mday = wrap(a, 100),
+				.tm_mon = wrap(b, 12), .tm_wday = wrap(a, 7) };
+
+			char expected[TEXT_DATE_SIZE];
+			formatDate(s_date, &wrapped);
+			memcpy(expected, s_date, sizeof(expected));
+			formatDate(s_date, &wild);
+			EXPECT(strcmp(s_date, expected) == 0, "%d/%d: date \"%s\", wrapped \"%s\"", a, b, s_date, expected);
+
+			for (int format = 0; format < 2; format++) {
+				formatDigitalTime(s_time, &wrapped, format);
+				memcpy(expected, s_time, TEXT_TIME_SIZE);
+				formatDigitalTime(s_time, &wild, format);
+				EXPECT(strcmp(s_time, expected) == 0, "%d/%d: time \"%s\", wrapped \"%s\"", a, b, s_time, expected);
+
+				formatNumeral(s_numeral, b, format);
+				EXPECT(strlen(s_numeral) >= 1 && strlen(s_numeral) <= 2, "%d: numeral \"%s\"", b, s_numeral);
+				expectNumeral(wrap(b, 24), format);
+			}
+		}
+	}
+	// The wrapped fields in turn are strftime's answer
+	struct tm tick_time = { .tm_min = 59, .tm_hour = 23, .tm_mday = 99, .tm_mon = 11, .tm_wday = 6 };
+	expectTexts(&tick_time);
+}
+
+int main(void) {
+	s_numeral = malloc(TEXT_NUMERAL_SIZE);
+	s_date = malloc(TEXT_DATE_SIZE);
+	s_time = malloc(TEXT_TIME_SIZE);
+	testYear();
+	testOutOfRange();
+	free(s_numeral);
+	free(s_date);
+	free(s_time);
+	return hostResult("text_format");
+}
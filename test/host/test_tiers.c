@@ -0,0 +1,83 @@
+// What the render tier and the hourly chime do to each other. Only the full
+// tier glides the hand, and the chime sounds once at the top of the hour
+// however often the face redraws during that minute.
+
+#include "macro_clock.h"
+
+// Monday 10:59
+#define BEFORE_HOUR (HOST_START_TIME + 10 * 3600 + 59 * 60)
+
+static const BatteryChargeState FULL = { .charge_percent = 80 };
+static const BatteryChargeState REDUCED = { .charge_percent = 25 };
+static const BatteryChargeState MINIMAL = { .charge_percent = 5 };
+static const BatteryChargeState CHARGING = { .charge_percent = 5, .is_charging = true };
+
+static void smooth(Settings *settings) {
+	settings->smoothMotion = true;
+}
+
+static void chime(Settings *settings) {
+	settings->vibeToggle = true;
+}
+
+// Whether the next minute's tick starts a glide
+static bool glides() {
+	int before = shim_stats.created[SK_ANIMATION];
+	runMinute();
+	shim_advance_ms(SMOOTH_DURATION_MS + 100);
+	return shim_stats.created[SK_ANIMATION] > before;
+}
+
+static void testGlide() {
+	startApp(BEFORE_HOUR - 30 * 60, smooth);
+	shim_set_battery(FULL);
+	EXPECT(glides(), "no glide on the full tier");
+	shim_set_battery(REDUCED);
+	EXPECT(!glides(), "glide on the reduced tier");
+	shim_set_battery(CHARGING);
+	EXPECT(glides(), "no glide while charging");
+	stopApp();
+}
+
+static void testChimeOnce() {
+	startApp(BEFORE_HOUR, chime);
+	shim_set_battery(FULL);
+	runMinute();
+	EXPECT(shim_vibe_count() == 1, "%d chimes at 11:00", shim_vibe_count());
+
+	// Everything else that runs update_time in the same minute
+	shim_set_battery(REDUCED);
+	shim_set_battery(MINIMAL);
+	shim_set_battery(CHARGING);
+	static const uint8_t FORMAT[] = { MK_HOUR_FORMAT, 1 };
+	sendConfig(FORMAT, sizeof(FORMAT));
+	shim_tap();
+	EXPECT(shim_vibe_count() == 1, "%d chimes after redraws at 11:00", shim_vibe_count());
+
+	// Hourly ticks on the minimal tier still chime
+	shim_set_battery(MINIMAL);
+	for (int minute = 1; minute <= 60; minute++) {
+		runMinute();
+	}
+	EXPECT(shim_vibe_count() == 2, "%d chimes by 12:00 on the minimal tier", shim_vibe_count());
+	stopApp();
+}
+
+// The default quiet hours, midnight to 8:00, have no chime
+static void testQuiet() {
+	startApp(HOST_START_TIME + 6 * 3600 + 59 * 60, chime);
+	runMinute();
+	EXPECT(shim_vibe_count() == 0, "chime at 7:00");
+	for (int minute = 0; minute < 60; minute++) {
+		runMinute();
+	}
+	EXPECT(shim_vibe_count() == 1, "%d chimes at 8:00", shim_vibe_count());
+	stopApp();
+}
+
+int main(void) {
+	testGlide();
+	testChimeOnce();
+	testQuiet();
+	return hostResult("tiers");
+}
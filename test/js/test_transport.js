@@ -0,0 +1,328 @@
+// The settings transport of src/macroClockJS.js over a simulated lossy
+// channel, on a fake clock. Run with `node test/js/test_transport.js`.
+//
+// The script is loaded the way the phone loads it, as one plain script, into
+// a context that stands in for Pebble, window and setTimeout.
+
+var assert = require('assert');
+var fs = require('fs');
+var path = require('path');
+var vm = require('vm');
+
+var SCRIPT = path.join(__dirname, '..', '..', 'src', 'macroClockJS.js');
+
+// Watch inbox and its per-tuple overhead, as in app_message_open(128, 128)
+var INBOX_SIZE = 128;
+var TUPLE_HEADER = 7;
+var LATENCY_MS = 20;
+var TIMEOUT_MS = 1000;
+
+// Deterministic, so a failure replays
+function random(seed) {
+	var state = seed;
+	return function() {
+		state = (state * 1103515245 + 12345) & 0x7fffffff;
+		return state / 0x80000000;
+	};
+}
+
+function FakeClock() {
+	var clock = this;
+	clock.now = 0;
+	var timers = [];
+	clock.setTimeout = function(fn, delay) {
+		timers.push({ at: clock.now + delay, fn: fn, order: timers.length });
+	};
+	clock.run = function() {
+		while (timers.length > 0) {
+			timers.sort(function(a, b) {
+				return a.at - b.at || a.order - b.order;
+			});
+			var timer = timers.shift();
+			clock.now = timer.at;
+			timer.fn();
+		}
+	};
+}
+
+function FakeStorage() {
+	var items = {};
+	this.getItem = function(key) {
+		return items.hasOwnProperty(key) ? items[key] : null;
+	};
+	this.setItem = function(key, value) {
+		items[key] = String(value);
+	};
+}
+
+// The watch end of applyConfigMessage: a repeated seq is acknowledged but not applied
+function FakeWatch() {
+	var watch = this;
+	watch.pairs = [];
+	watch.quietHours = [];
+	watch.applied = 0;
+	var lastSeq;
+	watch.receive = function(message) {
+		if (message['seq'] === lastSeq) {
+			return;
+		}
+		lastSeq = message['seq'];
+		watch.applied++;
+		if (message['config']) {
+			watch.pairs = watch.pairs.concat(message['config']);
+		}
+		if (message['quietHours']) {
+			watch.quietHours.push(message['quietHours']);
+		}
+	};
+}
+
+// outcome(message, sent) picks what happens to each send:
+//   'ack'      delivered and acknowledged
+//   'nack'     the phone's link was busy, nothing reached the watch
+//   'drop'     the watch inbox dropped it, which the phone sees as a NACK
+//   'lost_ack' applied on the watch, but the ACK never came back
+function LossyChannel(clock, watch, outcome) {
+	var channel = this;
+	channel.sent = [];
+	channel.nacks = [];
+	channel.send = function(message, ack, nack) {
+		var copy = JSON.parse(JSON.stringify(message));
+		channel.sent.push({ at: clock.now, message: copy });
+		switch (outcome(copy, channel.sent.length)) {
+			case 'ack':
+				watch.receive(copy);
+				clock.setTimeout(function() { ack({}); }, LATENCY_MS);
+				break;
+			case 'lost_ack':
+				watch.receive(copy);
+				clock.setTimeout(function() {
+					channel.nacks.push(clock.now);
+					nack({ error: { message: 'APP_MSG_SEND_TIMEOUT' } });
+				}, TIMEOUT_MS);
+				break;
+			default:
+				clock.setTimeout(function() {
+					channel.nacks.push(clock.now);
+					nack({ error: { message: 'APP_MSG_BUSY' } });
+				}, LATENCY_MS);
+				break;
+		}
+	};
+}
+
+function loadScript(clock, storage, sendAppMessage) {
+	var listeners = {};
+	var context = vm.createContext({
+		Pebble: {
+			addEventListener: function(name, listener) {
+				listeners[name] = listener;
+			},
+			sendAppMessage: sendAppMessage,
+			openURL: function() {}
+		},
+		window: { localStorage: storage },
+		setTimeout: clock.setTimeout,
+		console: { log: function() {} }
+	});
+	vm.runInContext(fs.readFileSync(SCRIPT, 'utf8'), context, { filename: SCRIPT });
+	context.listeners = listeners;
+	return context;
+}
+
+function randomPairs(next, count) {
+	var bytes = [];
+	for (var i = 0; i < count; i++) {
+		bytes.push(Math.floor(next() * 19), Math.floor(next() * 256));
+	}
+	return bytes;
+}
+
+function messageSize(message) {
+	var size = 1;
+	for (var key in message) {
+		if (message.hasOwnProperty(key)) {
+			size += TUPLE_HEADER + (key === 'seq' ? 4 : message[key].length);
+		}
+	}
+	return size;
+}
+
+var tests = [];
+function test(name, fn) {
+	tests.push({ name: name, fn: fn });
+}
+
+test('chunks are whole pairs that fit the inbox', function() {
+	var clock = new FakeClock();
+	var watch = new FakeWatch();
+	var channel = new LossyChannel(clock, watch, function() { return 'ack'; });
+	var script = loadScript(clock, new FakeStorage(), channel.send);
+	var sendConfig = script.createTransport(channel.send, clock.setTimeout, new FakeStorage());
+
+	assert.strictEqual(script.MAX_CHUNK, 108);
+	var bytes = randomPairs(random(1), 150);
+	var done = 0;
+	sendConfig(bytes, undefined, function() { done++; });
+	clock.run();
+
+	assert.deepStrictEqual(channel.sent.map(function(sent) { return sent.message['config'].length; }), [108, 108, 84]);
+	channel.sent.forEach(function(sent) {
+		assert.strictEqual(sent.message['config'].length % 2, 0);
+		assert.ok(messageSize(sent.message) <= INBOX_SIZE, 'message of ' + messageSize(sent.message) + ' bytes');
+	});
+	assert.deepStrictEqual(watch.pairs, bytes);
+	assert.strictEqual(done, 1);
+});
+
+test('seq increases with every chunk and survives a relaunch', function() {
+	var clock = new FakeClock();
+	var storage = new FakeStorage();
+	var watch = new FakeWatch();
+	var channel = new LossyChannel(clock, watch, function() { return 'ack'; });
+	var script = loadScript(clock, storage, channel.send);
+
+	script.createTransport(channel.send, clock.setTimeout, storage)(randomPairs(random(2), 100), [1, 2, 3], function() {});
+	clock.run();
+	script.createTransport(channel.send, clock.setTimeout, storage)(randomPairs(random(3), 10), undefined, function() {});
+	clock.run();
+
+	var seqs = channel.sent.map(function(sent) { return sent.message['seq']; });
+	assert.deepStrictEqual(seqs, [1, 2, 3, 4]);
+	assert.strictEqual(storage.getItem('macroClockSeq'), '4');
+	assert.deepStrictEqual(channel.sent[2].message['quietHours'], [1, 2, 3]);
+});
+
+test('retries back off exponentially and give up after MAX_RETRIES', function() {
+	var clock = new FakeClock();
+	var watch = new FakeWatch();
+	// The second chunk of the first transfer never gets through
+	var channel = new LossyChannel(clock, watch, function(message) {
+		return message['seq'] === 2 ? 'nack' : 'ack';
+	});
+	var script = loadScript(clock, new FakeStorage(), channel.send);
+	var sendConfig = script.createTransport(channel.send, clock.setTimeout, new FakeStorage());
+
+	var first = randomPairs(random(4), 150);
+	var second = randomPairs(random(5), 5);
+	var done = [];
+	sendConfig(first, undefined, function() { done.push('first'); });
+	sendConfig(second, undefined, function() { done.push('second'); });
+	clock.run();
+
+	var sends = channel.sent.filter(function(sent) { return sent.message['seq'] === 2; });
+	assert.strictEqual(sends.length, 1 + script.MAX_RETRIES);
+	var delays = [];
+	for (var i = 1; i < sends.length; i++) {
+		delays.push(sends[i].at - channel.nacks[i - 1]);
+	}
+	assert.deepStrictEqual(delays, [250, 500, 1000, 2000, 4000]);
+
+	// The rest of the first transfer is dropped, the next one still goes out
+	assert.ok(!channel.sent.some(function(sent) { return sent.message['seq'] === 3; }), 'chunk after the failed one was sent');
+	assert.deepStrictEqual(done, ['second']);
+	assert.deepStrictEqual(watch.pairs, first.slice(0, 108).concat(second));
+});
+
+test('every pair arrives once, in order, over a lossy channel', function() {
+	var clock = new FakeClock();
+	var watch = new FakeWatch();
+	var next = random(6);
+	var failures = 0;
+	// Never more failures in a row than the transport retries
+	var channel = new LossyChannel(clock, watch, function() {
+		var roll = next();
+		var outcome = roll < 0.55 ? 'ack' : roll < 0.7 ? 'nack' : roll < 0.85 ? 'drop' : 'lost_ack';
+		if (outcome !== 'ack' && failures === 3) {
+			outcome = 'ack';
+		}
+		failures = outcome === 'ack' ? 0 : failures + 1;
+		return outcome;
+	});
+	var script = loadScript(clock, new FakeStorage(), channel.send);
+	var sendConfig = script.createTransport(channel.send, clock.setTimeout, new FakeStorage());
+
+	var expected = [];
+	var done = 0;
+	for (var transfer = 0; transfer < 40; transfer++) {
+		var bytes = randomPairs(next, 1 + Math.floor(next() * 120));
+		expected = expected.concat(bytes);
+		var applied = expected.length;
+		sendConfig(bytes, undefined, (function(applied) {
+			return function() {
+				// done only runs once the watch has the whole transfer
+				assert.strictEqual(watch.pairs.length, applied);
+				done++;
+			};
+		})(applied));
+	}
+	clock.run();
+
+	assert.strictEqual(done, 40);
+	assert.deepStrictEqual(watch.pairs, expected);
+	assert.ok(channel.sent.length > watch.applied, 'the channel lost nothing');
+});
+
+test('options are stored only once the watch acknowledged them', function() {
+	var clock = new FakeClock();
+	var storage = new FakeStorage();
+	var watch = new FakeWatch();
+	var fail = false;
+	var channel = new LossyChannel(clock, watch, function() { return fail ? 'drop' : 'ack'; });
+	var script = loadScript(clock, storage, channel.send);
+	function close(options) {
+		script.listeners['webviewclosed']({ response: encodeURIComponent(JSON.stringify(options)) });
+	}
+
+	close({ backgroundColor: 'blk', smoothMotion: 'onn' });
+	assert.strictEqual(storage.getItem('macroClockOptions'), null);
+	clock.run();
+	assert.deepStrictEqual(JSON.parse(storage.getItem('macroClockOptions')), { backgroundColor: 'blk', smoothMotion: 'onn' });
+
+	// Given up on, the watch still has the old options and so does the diff base
+	fail = true;
+	close({ backgroundColor: 'wht', smoothMotion: 'onn' });
+	clock.run();
+	assert.deepStrictEqual(JSON.parse(storage.getItem('macroClockOptions')), { backgroundColor: 'blk', smoothMotion: 'onn' });
+});
+
+test('chime times from a page leave the saved schedule alone', function() {
+	var clock = new FakeClock();
+	var storage = new FakeStorage();
+	var watch = new FakeWatch();
+	var channel = new LossyChannel(clock, watch, function() { return 'ack'; });
+	var script = loadScript(clock, storage, channel.send);
+	function close(options) {
+		script.listeners['webviewclosed']({ response: encodeURIComponent(JSON.stringify(options)) });
+		clock.run();
+	}
+
+	// A schedule the user never touched is not sent
+	close({ vibeToggle: 'onn', chimePattern: '0' });
+	assert.deepStrictEqual(watch.quietHours, []);
+
+	var schedule = '0008000800080008000800080008';
+	close({ vibeToggle: 'onn', quietHours: schedule });
+	assert.strictEqual(watch.quietHours.length, 1);
+
+	close({ vibeToggle: 'onn', vibeStartTime: '09a', vibeEndTime: '10p' });
+	assert.strictEqual(watch.quietHours.length, 1);
+	assert.strictEqual(JSON.parse(storage.getItem('macroClockOptions'))['quietHours'], schedule);
+});
+
+var failed = 0;
+tests.forEach(function(t) {
+	try {
+		t.fn();
+		console.log('ok   ' + t.name);
+	}
+	catch (e) {
+		failed++;
+		console.log('FAIL ' + t.name + '\n' + e.stack);
+	}
+});
+if (failed > 0) {
+	console.log('transport: ' + failed + ' failed');
+	process.exit(1);
+}
+console.log('transport: ok');
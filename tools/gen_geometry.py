@@ -0,0 +1,215 @@
+#!/usr/bin/env python
+#
+# Generates src/geometry_table.h, the fixed point cosine tables used to place
+# the dot ring and the hour numerals, and checks the table driven layout
+# against an exact-pi reference for every minute of the dial. There is one
+# table per screen size, selected at compile time; the dial radius scales with
+# the screen width. On 144x168 the deviation from the original floating point
+# layout is reported as well.
+#
+# Run it through waf with `./waf geometry`, or directly with
+# `python tools/gen_geometry.py [output]`.
+#
+
+from __future__ import print_function
+
+import math
+import os
+import sys
+
+STEPS = 720            # half degree resolution
+SHIFT = 16             # table entries are radius * cos(angle) in Q16
+SCALE = 1 << SHIFT
+
+# (platform macros, width, height). The first entry is the layout the face was
+# designed on and is the fallback for any platform not listed.
+PLATFORMS = [
+    (['aplite', 'basalt'], 144, 168),
+    (['chalk'], 180, 180),
+    (['emery'], 200, 228),
+]
+BASE_WIDTH = 144
+BASE_RADIUS = 250
+
+NUMERAL_OFFSET = 25    # the numerals are drawn in a 50x50 box centered on their point
+HAND_OVERHANG = 15     # how far the hand reaches past the screen corners
+
+TRIG_MAX_ANGLE = 0x10000
+TRIG_MAX_RATIO = 0xffff
+FIRMWARE_PI = 3.14      # the M_PI the float layout was written against
+
+# Largest difference, in pixels, tolerated against the original float
+# layout. That layout truncates sums of rounded cos_lookup() values where the
+# table rounds to the nearest pixel, so they disagree by one pixel on a
+# handful of positions. The exact-pi reference has to match exactly.
+MAX_LEGACY_ERROR = 1
+
+
+def radius_for(width):
+    # Kept even: with an odd radius the 30 and 60 degree points land exactly on
+    # half a pixel and the rounding of the table decides which way they go
+    return 2 * int(round(BASE_RADIUS * float(width) / (2 * BASE_WIDTH)))
+
+
+def hand_length_for(width, height):
+    return int(math.hypot(width, height) / 2) + HAND_OVERHANG
+
+
+def table(radius):
+    return [int(round(radius * SCALE * math.cos(math.radians(i / 2.0))))
+            for i in range(STEPS)]
+
+
+def table_cos(entries, angle):
+    return entries[angle % STEPS]
+
+
+def table_sin(entries, angle):
+    return entries[(angle - STEPS // 4) % STEPS]
+
+
+def table_point(entries, point_angle, time_angle, origin_x, origin_y):
+    # Mirrors getDialPoint() in macroClockMain.c, rounding to the nearest pixel.
+    # Angles here are table indices; the C side rounds its TRIG_MAX_ANGLE
+    # angles to the same indices.
+    half = SCALE // 2
+    x = (table_cos(entries, point_angle) - table_cos(entries, time_angle) +
+         (origin_x << SHIFT) + half) >> SHIFT
+    y = (table_sin(entries, time_angle) - table_sin(entries, point_angle) +
+         (origin_y << SHIFT) + half) >> SHIFT
+    return x, y
+
+
+def exact_point(radius, point_angle, time_angle, origin_x, origin_y):
+    def cos(angle):
+        return radius * math.cos(math.radians(angle / 2.0))
+
+    def sin(angle):
+        return radius * math.sin(math.radians(angle / 2.0))
+    x = cos(point_angle) - cos(time_angle) + origin_x
+    y = sin(time_angle) - sin(point_angle) + origin_y
+    return int(math.floor(x + 0.5)), int(math.floor(y + 0.5))
+
+
+def lookup(angle):
+    angle &= TRIG_MAX_ANGLE - 1
+    return int(round(math.cos(2 * math.pi * angle / TRIG_MAX_ANGLE) * TRIG_MAX_RATIO))
+
+
+def float_cos(angle):
+    return float(lookup(int(angle * TRIG_MAX_ANGLE / (2 * FIRMWARE_PI)))) / TRIG_MAX_RATIO
+
+
+def float_sin(angle):
+    return float_cos(angle - FIRMWARE_PI / 2)
+
+
+def float_point(radius, point_rad, time_rad, origin_x, origin_y):
+    x = int((float_cos(point_rad) - float_cos(time_rad)) * radius + origin_x)
+    y = int((float_sin(time_rad) - float_sin(point_rad)) * radius + origin_y)
+    return x, y
+
+
+def check(entries, radius, width, height, legacy_check):
+    pi = FIRMWARE_PI
+    screen_mid_x = width // 2
+    screen_mid_y = height // 2
+    mid_x = screen_mid_x - NUMERAL_OFFSET
+    mid_y = screen_mid_y - NUMERAL_OFFSET
+    worst = 0
+    for minute in range(12 * 60):
+        path_angle = minute // 2
+        hour_angle = (minute // 60) * 60 // 2
+        path_rad = -(path_angle * pi / 180) + (pi / 2)
+        hour_rad = -(hour_angle * pi / 180) + (pi / 2)
+        path_half = 180 - 2 * path_angle
+        hour_half = 180 - 2 * hour_angle
+
+        points = []
+        for dot in range(3):
+            for step in range(1, 4):
+                points.append((hour_half - (dot * 60 - step * 15),
+                               hour_rad - (dot * pi / 6 - step * pi / 24),
+                               screen_mid_x, screen_mid_y))
+        for numeral in range(2):
+            points.append((hour_half - numeral * 60, hour_rad - numeral * pi / 6,
+                           mid_x, mid_y))
+
+        for half, rad, origin_x, origin_y in points:
+            actual = table_point(entries, half, path_half, origin_x, origin_y)
+            exact = exact_point(radius, half, path_half, origin_x, origin_y)
+            if actual != exact:
+                raise ValueError('%dx%d minute %d: table gives %r, exact layout gives %r'
+                                 % (width, height, minute, actual, exact))
+            if not legacy_check:
+                continue
+            legacy = float_point(radius, rad, path_rad, origin_x, origin_y)
+            error = max(abs(legacy[0] - actual[0]), abs(legacy[1] - actual[1]))
+            if error > MAX_LEGACY_ERROR:
+                raise ValueError('minute %d: table gives %r, float layout gives %r'
+                                 % (minute, actual, legacy))
+            worst = max(worst, error)
+    return worst
+
+
+def render(platforms):
+    lines = [
+        '// Generated by tools/gen_geometry.py, do not edit by hand.',
+        '//',
+        '// GEOMETRY_COS[i] is radius * cos(i / 2 degrees) in Q%d fixed point, so' % SHIFT,
+        '// every point on the dial is a difference of two table entries. Only the',
+        '// table for the screen being built for is compiled in.',
+        '',
+        '#pragma once',
+        '',
+        '#include <stdint.h>',
+        '',
+        '#define GEOMETRY_STEPS %d' % STEPS,
+        '#define GEOMETRY_SHIFT %d' % SHIFT,
+        '#define GEOMETRY_SCALE (1 << GEOMETRY_SHIFT)',
+        '',
+    ]
+    fallback = platforms[0]
+    ordered = platforms[1:] + [fallback]
+    for index, (names, width, height, radius, entries) in enumerate(ordered):
+        condition = ' || '.join('defined(PBL_PLATFORM_%s)' % name.upper() for name in names)
+        if index == len(ordered) - 1:
+            lines.append('#else // %s, %dx%d' % (', '.join(names), width, height))
+        else:
+            lines.append('#%s %s // %dx%d' % ('if' if index == 0 else 'elif', condition, width, height))
+        lines.append('#define GEOMETRY_RADIUS %d' % radius)
+        lines.append('#define GEOMETRY_HAND_LENGTH %d' % hand_length_for(width, height))
+        lines.append('static const int32_t GEOMETRY_COS[GEOMETRY_STEPS] = {')
+        for row in range(0, STEPS, 8):
+            lines.append('\t' + ', '.join('%d' % v for v in entries[row:row + 8]) + ',')
+        lines.append('};')
+    lines.append('#endif')
+    lines.append('')
+    return '\n'.join(lines)
+
+
+def generate(path):
+    platforms = []
+    worst = 0
+    for index, (names, width, height) in enumerate(PLATFORMS):
+        radius = radius_for(width)
+        entries = table(radius)
+        error = check(entries, radius, width, height, legacy_check=index == 0)
+        if index == 0:
+            worst = error
+        platforms.append((names, width, height, radius, entries))
+    with open(path, 'w') as out:
+        out.write(render(platforms))
+    return worst
+
+
+def main(argv):
+    here = os.path.dirname(os.path.abspath(__file__))
+    path = argv[1] if len(argv) > 1 else os.path.join(here, '..', 'src', 'geometry_table.h')
+    worst = generate(path)
+    print('wrote %s (max deviation from float layout: %d px)' % (os.path.normpath(path), worst))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
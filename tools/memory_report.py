@@ -0,0 +1,96 @@
+#!/usr/bin/env python
+#
+# Reports how much of the app RAM a built pebble-app.elf needs on its
+# platform, and fails when that is more than the platform has. The app image
+# (.text, .rodata, .data) and .bss are read from the ELF section headers; the
+# heap is the face's own allocations, estimated from the screen size, since
+# the real high-water mark is only known on the watch.
+#
+# The waf build runs it for every target platform. It also runs directly:
+# `python tools/memory_report.py <platform> build/<platform>/pebble-app.elf`.
+#
+
+from __future__ import print_function
+
+import struct
+import sys
+
+# App RAM per platform: code, data, bss and heap all come out of this.
+APP_RAM = {
+    'aplite': 24 * 1024,
+    'basalt': 64 * 1024,
+    'chalk': 64 * 1024,
+    'diorite': 64 * 1024,
+    'emery': 128 * 1024,
+}
+
+# (width, height, bits per pixel) of each frame buffer; the dial cache copies it
+SCREENS = {
+    'aplite': (144, 168, 1),
+    'basalt': (144, 168, 8),
+    'chalk': (180, 180, 8),
+    'diorite': (144, 168, 1),
+    'emery': (200, 228, 8),
+}
+
+# Window, layers, paths, the hand animation and the AppMessage buffers
+# opened with app_message_open(128, 128), with allocator overhead.
+HEAP_BASE = 3 * 1024
+
+SHF_WRITE = 0x1
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+
+def section_sizes(path):
+    with open(path, 'rb') as elf:
+        data = elf.read()
+    if data[:4] != b'\x7fELF' or data[4:5] != b'\x01':
+        raise ValueError('%s is not a 32-bit ELF file' % path)
+    endian = '<' if data[5:6] == b'\x01' else '>'
+    shoff, = struct.unpack_from(endian + 'I', data, 0x20)
+    shentsize, shnum = struct.unpack_from(endian + 'HH', data, 0x2e)
+
+    text = rwdata = bss = 0
+    for index in range(shnum):
+        fields = struct.unpack_from(endian + 'IIIIIIIIII', data, shoff + index * shentsize)
+        sh_type, sh_flags, sh_size = fields[1], fields[2], fields[5]
+        if not sh_flags & SHF_ALLOC:
+            continue
+        if sh_type == SHT_NOBITS:
+            bss += sh_size
+        elif sh_flags & SHF_WRITE:
+            rwdata += sh_size
+        else:
+            text += sh_size
+    return text, rwdata, bss
+
+
+def heap_estimate(platform):
+    width, height, bpp = SCREENS[platform]
+    # gbitmap rows are padded to whole 32-bit words
+    row = ((width * bpp + 31) // 32) * 4
+    return HEAP_BASE + row * height
+
+
+def report(platform, path):
+    text, rwdata, bss = section_sizes(path)
+    heap = heap_estimate(platform)
+    total = text + rwdata + bss + heap
+    budget = APP_RAM[platform]
+    line = ('%s: .text %d, static RAM %d (.data %d, .bss %d), heap ~%d, total %d of %d bytes (%d free)'
+            % (platform, text, rwdata + bss, rwdata, bss, heap, total, budget, budget - total))
+    return line, total <= budget
+
+
+def main(argv):
+    if len(argv) != 3:
+        print('usage: %s <platform> <pebble-app.elf>' % argv[0])
+        return 2
+    line, fits = report(argv[1], argv[2])
+    print(line)
+    return 0 if fits else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))